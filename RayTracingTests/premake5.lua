@@ -0,0 +1,63 @@
+project "RayTracingTests"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++20"
+   staticruntime "off"
+
+   -- The checks build against the renderer sources, everything but the app's entry point.
+   files
+   {
+      "src/**.h",
+      "src/**.cpp",
+      "../RayTracingTut/src/**.h",
+      "../RayTracingTut/src/**.cpp",
+   }
+
+   removefiles { "../RayTracingTut/src/WalnutApp.cpp" }
+
+   includedirs
+   {
+      "../RayTracingTut/src",
+
+      "../Walnut/vendor/imgui",
+      "../Walnut/vendor/glfw/include",
+      "../Walnut/vendor/glm",
+
+      "../Walnut/Walnut/src",
+
+      "%{IncludeDir.VulkanSDK}",
+   }
+
+   links
+   {
+       "Walnut"
+   }
+
+   targetdir ("../bin/" .. outputdir .. "/%{prj.name}")
+   objdir ("../bin-int/" .. outputdir .. "/%{prj.name}")
+   -- The default golden directory is relative to the repository root.
+   debugdir "%{wks.location}"
+
+   filter "files:../RayTracingTut/src/UtilsAvx2.cpp"
+      vectorextensions "AVX2"
+
+   filter "system:windows"
+      systemversion "latest"
+      defines { "WL_PLATFORM_WINDOWS" }
+
+   filter "configurations:Debug"
+      defines { "WL_DEBUG" }
+      runtime "Debug"
+      symbols "On"
+
+   filter "configurations:Release"
+      defines { "WL_RELEASE" }
+      runtime "Release"
+      optimize "On"
+      symbols "On"
+
+   filter "configurations:Dist"
+      defines { "WL_DIST" }
+      runtime "Release"
+      optimize "On"
+      symbols "Off"
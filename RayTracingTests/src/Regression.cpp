@@ -0,0 +1,519 @@
+#include "Regression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "Bsdf.h"
+#include "Camera.h"
+#include "ImageWriter.h"
+#include "PathTracer.h"
+#include "Ray.h"
+#include "ReferenceScene.h"
+#include "RenderBackend.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "SceneEditor.h"
+#include "Utils.h"
+
+namespace
+{
+	constexpr uint32_t ImageWidth = 160;
+	constexpr uint32_t ImageHeight = 90;
+	constexpr uint32_t SampleCount = 8;
+
+	class Report
+	{
+	public:
+		void Check(bool condition, const std::string& name)
+		{
+			std::printf("[%s] %s\n", condition ? "PASS" : "FAIL", name.c_str());
+			if (condition)
+			{
+				_passed++;
+			}
+			else
+			{
+				_failed++;
+			}
+		}
+
+		uint32_t GetFailed() const { return _failed; }
+		uint32_t GetPassed() const { return _passed; }
+
+	private:
+		uint32_t _passed = 0;
+		uint32_t _failed = 0;
+	};
+
+	enum class RenderMode
+	{
+		Serial,
+		MultiThread,
+		MultiThreadInner,
+		Numa,
+		// Serial, through a SceneEditor snapshot and its scene bounds.
+		Snapshot,
+		// Serial, intersecting the packed spheres of a snapshot.
+		CompactSnapshot,
+	};
+
+	bool Intersects(const Ray& ray, const Sphere& sphere, float& distance)
+	{
+		distance = std::numeric_limits<float>::max();
+		return PathTracer::IntersectSphere(ray, sphere, distance);
+	}
+
+	bool IsNear(float value, float expected)
+	{
+		return glm::abs(value - expected) <= 1e-4f;
+	}
+
+	void CheckIntersectSphere(Report& report)
+	{
+		Sphere unitSphere;
+		unitSphere.Radius = 1.0f;
+		unitSphere.Position = glm::vec3(0.0f);
+
+		float distance = 0.0f;
+		report.Check(Intersects({{0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f}}, unitSphere, distance) && IsNear(distance, 4.0f),
+			"IntersectSphere: hit from outside returns the near surface");
+
+		report.Check(Intersects({{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}, unitSphere, distance) && IsNear(distance, 1.0f),
+			"IntersectSphere: origin inside the sphere returns the far surface");
+
+		Sphere behindSphere = unitSphere;
+		behindSphere.Position = {-5.0f, 0.0f, 0.0f};
+		report.Check(!Intersects({{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}, behindSphere, distance),
+			"IntersectSphere: sphere behind the origin is missed");
+
+		report.Check(Intersects({{-5.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}, unitSphere, distance) && IsNear(distance, 5.0f),
+			"IntersectSphere: tangent ray touches at a single point");
+
+		report.Check(!Intersects({{-5.0f, 1.001f, 0.0f}, {1.0f, 0.0f, 0.0f}}, unitSphere, distance),
+			"IntersectSphere: ray just above the tangent misses");
+
+		report.Check(Intersects({{0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -2.0f}}, unitSphere, distance) && IsNear(distance, 2.0f),
+			"IntersectSphere: distance is in units of the unnormalized direction");
+
+		float closestHit = 3.0f;
+		report.Check(!PathTracer::IntersectSphere({{0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f}}, unitSphere, closestHit) && closestHit == 3.0f,
+			"IntersectSphere: farther hit keeps the current closest hit");
+	}
+
+	void CheckConvertToRGBA(Report& report)
+	{
+		report.Check(Utils::ConvertToRGBA(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)) == 0xff0000ffu,
+			"ConvertToRGBA: red lands in the low byte, alpha in the high byte");
+		report.Check(Utils::ConvertToRGBA(glm::vec3(0.0f, 0.0f, 1.0f)) == 0xffff0000u,
+			"ConvertToRGBA: vec3 packs blue with opaque alpha");
+		report.Check(Utils::ConvertToRGBA(glm::vec4(0.0f)) == 0u,
+			"ConvertToRGBA: zero packs to zero");
+		report.Check(Utils::ConvertToRGBA(glm::vec4(2.0f, -1.0f, 1.0f, 5.0f)) == 0xffff00ffu,
+			"ConvertToRGBA: out of range channels are clamped");
+		report.Check(Utils::ConvertToRGBA(glm::vec3(0.5f)) == 0xff808080u,
+			"ConvertToRGBA: half intensity rounds to 128");
+
+		// Enough pixels to go through the AVX2, SSE2 and scalar tail paths.
+		std::vector<glm::vec4> colors(23);
+		for (size_t i = 0; i < colors.size(); i++)
+		{
+			const float value = static_cast<float>(i) * 0.17f - 0.5f;
+			colors[i] = glm::vec4(value, value * 0.5f, 2.0f - value, 1.0f + value);
+		}
+
+		const std::pair<Utils::ToneMap, const char*> toneMaps[] = {
+			{Utils::ToneMap::None, "None"},
+			{Utils::ToneMap::Gamma, "Gamma"},
+			{Utils::ToneMap::Reinhard, "Reinhard"},
+		};
+
+		for (const auto& [toneMap, toneMapName] : toneMaps)
+		{
+			std::vector<uint32_t> bulk(colors.size());
+			Utils::ConvertToRGBA(colors, bulk, 0.5f, toneMap);
+
+			bool isMatching = true;
+			for (size_t i = 0; i < colors.size(); i++)
+			{
+				uint32_t single = 0;
+				Utils::ConvertToRGBA(std::span(&colors[i], 1), std::span(&single, 1), 0.5f, toneMap);
+				isMatching = isMatching && single == bulk[i];
+			}
+
+			report.Check(isMatching, std::string("ConvertToRGBA: ") + toneMapName + " span matches pixel by pixel conversion");
+		}
+
+		uint32_t gammaPixel = 0;
+		const glm::vec4 quarter(0.25f, 0.25f, 0.25f, 0.25f);
+		Utils::ConvertToRGBA(std::span(&quarter, 1), std::span(&gammaPixel, 1), 1.0f, Utils::ToneMap::Gamma);
+		report.Check(gammaPixel == 0x40808080u, "ConvertToRGBA: gamma applies to color but not alpha");
+	}
+
+	void CheckImageWriter(Report& report)
+	{
+		report.Check(ImageWriter::IsSupportedPath("out.png") && ImageWriter::IsSupportedPath("out.PFM") && ImageWriter::IsSupportedPath("out.Ppm"),
+			"ImageWriter: extensions are matched case-insensitively");
+		report.Check(!ImageWriter::IsSupportedPath("out.exr") && !ImageWriter::IsSupportedPath("out"),
+			"ImageWriter: unknown extensions are rejected");
+	}
+
+	void CheckSceneEditor(Report& report)
+	{
+		Scene scene = Scene::CreateDefault();
+		scene.Materials.emplace_back().Albedo = {0.1f, 0.2f, 0.3f};
+		SceneEditor sceneEditor(scene);
+		const auto initialSnapshot = sceneEditor.GetSnapshot();
+
+		sceneEditor.SetSphere(0, scene.Spheres[0]);
+		SceneEditor::Changes changes = sceneEditor.Commit();
+		report.Check(!changes.AffectsImage && sceneEditor.GetSnapshot() == initialSnapshot,
+			"SceneEditor: setting an unchanged sphere publishes nothing");
+
+		Material unusedMaterial = scene.Materials[2];
+		unusedMaterial.Roughness = 0.5f;
+		sceneEditor.SetMaterial(2, unusedMaterial);
+		changes = sceneEditor.Commit();
+		report.Check(!changes.AffectsImage && changes.EditedMaterials.size() == 1 && sceneEditor.GetVersion() == initialSnapshot->Version + 1,
+			"SceneEditor: editing an unused material does not affect the image");
+
+		Material usedMaterial = scene.Materials[0];
+		usedMaterial.Albedo = glm::vec3(0.5f);
+		sceneEditor.SetMaterial(0, usedMaterial);
+		changes = sceneEditor.Commit();
+		report.Check(changes.AffectsImage && !changes.HasGeometryChanged() && sceneEditor.GetSnapshot()->Geometry == initialSnapshot->Geometry,
+			"SceneEditor: material edits share the previous geometry");
+		report.Check(sceneEditor.GetSnapshot()->Spheres == initialSnapshot->Spheres && sceneEditor.GetSnapshot()->Materials != initialSnapshot->Materials,
+			"SceneEditor: material edits share the previous spheres");
+		report.Check((*initialSnapshot->Materials)[0].Albedo == scene.Materials[0].Albedo,
+			"SceneEditor: published snapshots stay unchanged");
+		const std::shared_ptr<const SceneSnapshot> materialSnapshot = sceneEditor.GetSnapshot();
+
+		Sphere movedSphere = scene.Spheres[0];
+		movedSphere.Position = {3.0f, 2.0f, 1.0f};
+		sceneEditor.SetSphere(0, movedSphere);
+		changes = sceneEditor.Commit();
+
+		SceneGeometry rebuiltGeometry;
+		rebuiltGeometry.Build(sceneEditor.GetScene().Spheres);
+		const std::shared_ptr<const SceneGeometry> refittedGeometryPointer = sceneEditor.GetSnapshot()->Geometry;
+		const SceneGeometry& refittedGeometry = *refittedGeometryPointer;
+		report.Check(changes.AffectsImage && changes.MovedSpheres.size() == 1 && !changes.IsStructural
+			&& refittedGeometry.SceneMin == rebuiltGeometry.SceneMin && refittedGeometry.SceneMax == rebuiltGeometry.SceneMax,
+			"SceneEditor: moving a sphere off a face of the scene box gives the same box as a rebuild");
+		report.Check(sceneEditor.GetSnapshot()->Materials == materialSnapshot->Materials && sceneEditor.GetSnapshot()->Spheres != materialSnapshot->Spheres,
+			"SceneEditor: sphere edits share the previous materials");
+
+		Sphere rematerializedSphere = scene.Spheres[1];
+		rematerializedSphere.MaterialIndex = 7;
+		sceneEditor.SetSphere(1, rematerializedSphere);
+		changes = sceneEditor.Commit();
+
+		const CompactSpheres& compact = *sceneEditor.GetSnapshot()->Compact;
+		report.Check(compact.Geometry[0].Center == movedSphere.Position && compact.Geometry[0].Radius == movedSphere.Radius
+			&& compact.MaterialIds[0] == static_cast<uint32_t>(movedSphere.MaterialIndex) && compact.MaterialIds[1] == CompactSpheres::InvalidMaterial,
+			"SceneEditor: compact spheres follow moves and flag out of range materials");
+
+		sceneEditor.AddSphere(Sphere());
+		changes = sceneEditor.Commit();
+		const std::shared_ptr<const SceneGeometry> addedGeometry = sceneEditor.GetSnapshot()->Geometry;
+		report.Check(changes.IsStructural && changes.AffectsImage && addedGeometry != refittedGeometryPointer,
+			"SceneEditor: adding a sphere rebuilds the geometry");
+
+		// The added sphere sits inside the box, moving it a little only grows the box.
+		Sphere innerSphere = sceneEditor.GetScene().Spheres[2];
+		innerSphere.Position.x += 0.1f;
+		sceneEditor.SetSphere(2, innerSphere);
+		sceneEditor.Commit();
+		rebuiltGeometry.Build(sceneEditor.GetScene().Spheres);
+		report.Check(sceneEditor.GetSnapshot()->Geometry->SceneMin == rebuiltGeometry.SceneMin
+			&& sceneEditor.GetSnapshot()->Geometry->SceneMax == rebuiltGeometry.SceneMax,
+			"SceneEditor: moving an inner sphere grows the scene box to the rebuilt box");
+	}
+
+	void CheckBsdf(Report& report)
+	{
+		const glm::vec3 normal(0.0f, 0.0f, 1.0f);
+		const glm::vec3 viewDirection = glm::normalize(glm::vec3(0.3f, 0.0f, 1.0f));
+		constexpr uint32_t BsdfSampleCount = 200000;
+
+		const std::pair<glm::vec2, const char*> materials[] = {
+			{{1.0f, 0.0f}, "rough dielectric"},
+			{{0.5f, 0.0f}, "glossy dielectric"},
+			{{1.0f, 1.0f}, "rough metal"},
+			{{0.5f, 1.0f}, "glossy metal"},
+		};
+
+		for (const auto& [roughnessMetallic, materialName] : materials)
+		{
+			Material material;
+			material.Albedo = glm::vec3(1.0f);
+			material.Roughness = roughnessMetallic.x;
+			material.Metallic = roughnessMetallic.y;
+			const Bsdf bsdf(material, normal, viewDirection);
+
+			// The importance sampled estimate and a uniform hemisphere estimate of the reflected energy have to agree.
+			// The albedo is white, so the red channel stands for all three.
+			uint32_t seed = 7;
+			double sampled = 0.0;
+			double uniform = 0.0;
+			bool isFinite = true;
+			for (uint32_t i = 0; i < BsdfSampleCount; i++)
+			{
+				const Bsdf::Sample sample = bsdf.SampleDirection(seed);
+				if (sample.IsValid)
+				{
+					isFinite = isFinite && std::isfinite(sample.Weight.x);
+					sampled += sample.Weight.x;
+				}
+
+				const float cosTheta = Utils::RandomFloat(seed);
+				const float sinTheta = glm::sqrt(1.0f - cosTheta * cosTheta);
+				const float phi = glm::two_pi<float>() * Utils::RandomFloat(seed);
+				const glm::vec3 direction(sinTheta * glm::cos(phi), sinTheta * glm::sin(phi), cosTheta);
+				uniform += bsdf.Evaluate(direction).x * glm::two_pi<float>();
+			}
+
+			sampled /= BsdfSampleCount;
+			uniform /= BsdfSampleCount;
+			const double difference = std::abs(sampled - uniform) / std::max(uniform, 1e-3);
+
+			char name[256];
+			std::snprintf(name, sizeof(name), "Bsdf: %s sampling matches evaluation (%.4f vs %.4f)", materialName, sampled, uniform);
+			report.Check(isFinite && difference < 0.03 && sampled <= 1.01, name);
+		}
+
+		// This seed hashes close enough to UINT32_MAX that a [0, 1] RandomFloat returned exactly 1.
+		uint32_t edgeSeed = 60418823;
+		report.Check(Utils::RandomFloat(edgeSeed) < 1.0f, "RandomFloat: stays below 1");
+
+		Material metal;
+		metal.Metallic = 1.0f;
+		edgeSeed = 60418823;
+		const Bsdf::Sample metalSample = Bsdf(metal, normal, viewDirection).SampleDirection(edgeSeed);
+		report.Check(!metalSample.IsValid || std::isfinite(metalSample.Weight.x),
+			"Bsdf: fully metallic sample weights stay finite");
+	}
+
+	std::vector<glm::vec4> RenderReference(const ReferenceScene& reference, RenderMode mode, bool useBsdfSampling = true,
+		std::string_view backendName = RenderBackendRegistry::GetDefaultName())
+	{
+		Renderer renderer(true);
+		renderer.SetBackend(backendName);
+		renderer.Bounces = 4;
+		renderer.LightDirection = {-1.0f, -1.0f, -1.0f};
+		renderer.BackColor = {0.6f, 0.7f, 0.9f};
+		renderer.IsMultiThread = mode == RenderMode::MultiThread || mode == RenderMode::MultiThreadInner;
+		renderer.IsMultiThreadInner = mode == RenderMode::MultiThreadInner;
+		renderer.IsNumaAware = mode == RenderMode::Numa;
+		renderer.IsCompactGeometry = mode == RenderMode::CompactSnapshot;
+		renderer.GetSettings().ShouldAccumulate = true;
+		renderer.GetSettings().Seed = 1234;
+		renderer.GetSettings().UseBsdfSampling = useBsdfSampling;
+		renderer.OnResize(ImageWidth, ImageHeight);
+
+		Camera camera(45.0f, 0.1f, 100.0f);
+		camera.OnResize(ImageWidth, ImageHeight);
+		camera.SetView(reference.CameraPosition, reference.CameraDirection);
+
+		const SceneEditor sceneEditor(reference.ReferenceSceneData);
+		for (uint32_t sample = 0; sample < SampleCount; sample++)
+		{
+			if (mode == RenderMode::Snapshot || mode == RenderMode::CompactSnapshot)
+			{
+				renderer.Render(sceneEditor.GetSnapshot(), camera);
+			}
+			else
+			{
+				renderer.Render(reference.ReferenceSceneData, camera);
+			}
+		}
+
+		const glm::vec4* accumulationData = renderer.GetAccumulationData();
+		std::vector<glm::vec4> image(accumulationData, accumulationData + ImageWidth * ImageHeight);
+		const float scale = 1.0f / static_cast<float>(renderer.GetAccumulatedSampleCount());
+		for (glm::vec4& pixel : image)
+		{
+			pixel *= scale;
+		}
+
+		return image;
+	}
+
+	bool ReadPfm(const std::filesystem::path& path, uint32_t& width, uint32_t& height, std::vector<glm::vec3>& pixels)
+	{
+		std::ifstream stream(path, std::ios::binary);
+		std::string magic;
+		float endianScale = 0.0f;
+		if (!(stream >> magic >> width >> height >> endianScale) || magic != "PF" || endianScale >= 0.0f)
+		{
+			return false;
+		}
+
+		// Exactly one whitespace character separates the header from the samples.
+		stream.get();
+		pixels.resize(static_cast<size_t>(width) * height);
+		stream.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(pixels.size() * sizeof(glm::vec3)));
+		return static_cast<bool>(stream);
+	}
+
+	void CompareModes(Report& report, const ReferenceScene& reference, const std::vector<glm::vec4>& serialImage)
+	{
+		const std::pair<RenderMode, const char*> modes[] = {
+			{RenderMode::MultiThread, "MultiThread"},
+			{RenderMode::MultiThreadInner, "MultiThreadInner"},
+			{RenderMode::Numa, "NUMA"},
+			{RenderMode::Snapshot, "Snapshot"},
+			{RenderMode::CompactSnapshot, "CompactSnapshot"},
+		};
+
+		for (const auto& [mode, modeName] : modes)
+		{
+			const std::vector<glm::vec4> image = RenderReference(reference, mode);
+			bool isIdentical = image.size() == serialImage.size();
+			for (size_t i = 0; isIdentical && i < image.size(); i++)
+			{
+				isIdentical = image[i] == serialImage[i];
+			}
+
+			report.Check(isIdentical, reference.Name + ": " + modeName + " matches the serial render");
+		}
+	}
+
+	void CompareBackends(Report& report, const ReferenceScene& reference, const std::vector<glm::vec4>& serialImage,
+		const std::vector<glm::vec4>& serialLegacyImage)
+	{
+		// Backends only change the order work is done in, every one has to reproduce the reference backend exactly.
+		for (const std::string_view backendName : RenderBackendRegistry::GetNames())
+		{
+			if (backendName == RenderBackendRegistry::GetDefaultName())
+			{
+				continue;
+			}
+
+			const std::pair<RenderMode, const char*> modes[] = {
+				{RenderMode::Serial, "serial"},
+				{RenderMode::MultiThread, "MultiThread"},
+				{RenderMode::CompactSnapshot, "CompactSnapshot"},
+			};
+
+			for (const auto& [mode, modeName] : modes)
+			{
+				const std::vector<glm::vec4> image = RenderReference(reference, mode, true, backendName);
+				report.Check(image == serialImage,
+					reference.Name + ": " + std::string(backendName) + " backend, " + modeName + ", matches the serial render");
+			}
+
+			report.Check(RenderReference(reference, RenderMode::Serial, false, backendName) == serialLegacyImage,
+				reference.Name + ": " + std::string(backendName) + " backend matches the legacy serial render");
+		}
+	}
+
+	template<typename Pixel>
+	double MeanLuminance(const std::vector<Pixel>& pixels)
+	{
+		double sum = 0.0;
+		for (const Pixel& pixel : pixels)
+		{
+			sum += 0.2126 * pixel.r + 0.7152 * pixel.g + 0.0722 * pixel.b;
+		}
+
+		return pixels.empty() ? 0.0 : sum / static_cast<double>(pixels.size());
+	}
+
+	void CompareGolden(Report& report, const std::string& imageName, const std::vector<glm::vec4>& image,
+		const std::filesystem::path& goldenPath, float tolerance)
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<glm::vec3> golden;
+		if (!ReadPfm(goldenPath, width, height, golden) || width != ImageWidth || height != ImageHeight)
+		{
+			report.Check(false, imageName + ": golden image " + goldenPath.string() + " is readable");
+			return;
+		}
+
+		// A black golden matches every black render, whatever broke to make it black.
+		if (MeanLuminance(golden) <= 0.0)
+		{
+			report.Check(false, imageName + ": golden image " + goldenPath.string() + " is not black");
+			return;
+		}
+
+		double squaredError = 0.0;
+		float maxError = 0.0f;
+		for (size_t i = 0; i < golden.size(); i++)
+		{
+			const glm::vec3 difference = glm::abs(glm::vec3(image[i]) - golden[i]);
+			squaredError += glm::dot(difference, difference);
+			maxError = glm::max(maxError, glm::max(difference.x, glm::max(difference.y, difference.z)));
+		}
+
+		const auto rmse = static_cast<float>(std::sqrt(squaredError / static_cast<double>(golden.size() * 3)));
+		char name[256];
+		std::snprintf(name, sizeof(name), "%s: matches golden (rmse %.5f, max %.5f, tolerance %.5f)",
+			imageName.c_str(), rmse, maxError, tolerance);
+		report.Check(rmse <= tolerance, name);
+	}
+}
+
+int Regression::Run(const Options& options)
+{
+	Report report;
+	CheckIntersectSphere(report);
+	CheckConvertToRGBA(report);
+	CheckImageWriter(report);
+	CheckSceneEditor(report);
+	CheckBsdf(report);
+
+	ImageWriter imageWriter;
+	for (const ReferenceScene& reference : ReferenceScene::CreateAll())
+	{
+		const std::vector<glm::vec4> serialImage = RenderReference(reference, RenderMode::Serial);
+		const std::vector<glm::vec4> serialLegacyImage = RenderReference(reference, RenderMode::Serial, false);
+		CompareModes(report, reference, serialImage);
+		CompareBackends(report, reference, serialImage, serialLegacyImage);
+
+		// The original shading keeps its own goldens so both integrators stay comparable.
+		const std::pair<std::string, std::vector<glm::vec4>> images[] = {
+			{reference.Name, serialImage},
+			{reference.Name + "_legacy", serialLegacyImage},
+		};
+
+		for (const auto& [imageName, image] : images)
+		{
+			const std::filesystem::path goldenPath = options.GoldenDirectory / (imageName + ".pfm");
+			if (options.ShouldUpdateGolden)
+			{
+				if (MeanLuminance(image) <= 0.0)
+				{
+					report.Check(false, imageName + ": new golden image is not black");
+					continue;
+				}
+
+				imageWriter.EnqueueHdr(goldenPath, ImageWidth, ImageHeight, image);
+				std::printf("[INFO] %s: golden image written to %s\n", imageName.c_str(), goldenPath.string().c_str());
+				continue;
+			}
+
+			CompareGolden(report, imageName, image, goldenPath, options.Tolerance);
+		}
+	}
+
+	imageWriter.Flush();
+	if (imageWriter.GetFailedCount() > 0)
+	{
+		report.Check(false, "golden images written");
+	}
+
+	std::printf("%u passed, %u failed\n", report.GetPassed(), report.GetFailed());
+	return report.GetFailed() == 0 ? 0 : 1;
+}
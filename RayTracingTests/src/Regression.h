@@ -0,0 +1,22 @@
+#pragma once
+
+#include <filesystem>
+
+// Headless correctness checks: intersection, packing and scene editing edge cases, render modes agreeing with each other,
+// and reference scenes compared against golden PFM images.
+class Regression
+{
+public:
+	struct Options
+	{
+		std::filesystem::path GoldenDirectory;
+		// Writes the golden images instead of comparing against them.
+		bool ShouldUpdateGolden = false;
+		// Maximum RMSE per channel against a golden image.
+		float Tolerance = 0.002f;
+	};
+
+public:
+	// Prints one line per check, returns the process exit code.
+	static int Run(const Options& options);
+};
@@ -0,0 +1,62 @@
+#include <charconv>
+#include <cstdio>
+#include <string_view>
+
+#include "Regression.h"
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::fprintf(stderr,
+			"Usage: RayTracingTests [options]\n"
+			"  --golden <dir>     Golden image directory (default RayTracingTests/golden, run from the repository root)\n"
+			"  --update-golden    Write the golden images instead of comparing\n"
+			"  --tolerance <rmse> Maximum RMSE against a golden image (default 0.002)\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Regression::Options options;
+	options.GoldenDirectory = "RayTracingTests/golden";
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string_view argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+		const std::string_view value = hasValue ? argv[i + 1] : std::string_view();
+
+		if (argument == "--update-golden")
+		{
+			options.ShouldUpdateGolden = true;
+			continue;
+		}
+
+		bool isValid = true;
+		if (argument == "--golden" && hasValue)
+		{
+			options.GoldenDirectory = value;
+		}
+		else if (argument == "--tolerance" && hasValue)
+		{
+			const auto result = std::from_chars(value.data(), value.data() + value.size(), options.Tolerance);
+			isValid = result.ec == std::errc() && result.ptr == value.data() + value.size() && options.Tolerance >= 0.0f;
+		}
+		else
+		{
+			isValid = false;
+		}
+
+		if (!isValid)
+		{
+			std::fprintf(stderr, "Unknown, incomplete or invalid argument '%.*s'\n", static_cast<int>(argument.size()), argument.data());
+			PrintUsage();
+			return 1;
+		}
+
+		i++;
+	}
+
+	return Regression::Run(options);
+}
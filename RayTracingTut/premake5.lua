@@ -26,6 +26,10 @@ project "RayTracingTut"
    targetdir ("../bin/" .. outputdir .. "/%{prj.name}")
    objdir ("../bin-int/" .. outputdir .. "/%{prj.name}")
 
+   -- Only the AVX2 kernels, Utils picks them at runtime when the CPU supports them.
+   filter "files:src/UtilsAvx2.cpp"
+      vectorextensions "AVX2"
+
    filter "system:windows"
       systemversion "latest"
       defines { "WL_PLATFORM_WINDOWS" }
@@ -0,0 +1,345 @@
+#include "Benchmark.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+#include "CompactSpheres.h"
+#include "ReferenceScene.h"
+#include "RenderBackend.h"
+#include "Renderer.h"
+#include "SceneEditor.h"
+#include "Utils.h"
+#include "Walnut/Timer.h"
+
+namespace
+{
+	// Bytes read and written per converted pixel.
+	constexpr double ConversionBytesPerPixel = sizeof(glm::vec4) + sizeof(uint32_t);
+
+	void PrintConversionResult(const char* name, double seconds, size_t pixelCount, uint32_t iterations, uint32_t checksum)
+	{
+		const double pixels = static_cast<double>(pixelCount) * iterations;
+		std::printf("%-28s %10.3f %10.2f %10.3f   %08x\n",
+			name, seconds * 1000.0 / iterations, pixels * ConversionBytesPerPixel / seconds * 1e-9, seconds * 1e9 / pixels, checksum);
+	}
+
+	void RunConversionBenchmark(const Benchmark::Options& options)
+	{
+		const size_t pixelCount = static_cast<size_t>(options.Width) * options.Height;
+		const float frameCount = 7.0f;
+
+		// Accumulated colors of a few frames, with some values over 1 so clamping matters.
+		std::vector<glm::vec4> colors(pixelCount);
+		uint32_t seed = 1;
+		for (glm::vec4& color : colors)
+		{
+			color = glm::vec4(Utils::RandomVec3(seed, 0.0f, 1.2f * frameCount), frameCount);
+		}
+
+		std::vector<uint32_t> output(pixelCount);
+		std::printf("\nTone map and pack, %ux%u, %u iterations\n", options.Width, options.Height, options.Iterations);
+		std::printf("%-28s %10s %10s %10s   %s\n", "Path", "ms/frame", "GB/s", "ns/pixel", "checksum");
+
+		const auto checksum = [&output]
+		{
+			uint32_t sum = 0;
+			for (const uint32_t pixel : output)
+			{
+				sum = sum * 31u + pixel;
+			}
+
+			return sum;
+		};
+
+		{
+			// What Renderer did per pixel before the bulk conversion.
+			Walnut::Timer timer;
+			for (uint32_t iteration = 0; iteration < options.Iterations; iteration++)
+			{
+				for (size_t i = 0; i < pixelCount; i++)
+				{
+					glm::vec4 color = colors[i];
+					color /= frameCount;
+					color = glm::clamp(color, glm::vec4(0.0f), glm::vec4(1.0f));
+					output[i] = Utils::ConvertToRGBA(color);
+				}
+			}
+
+			PrintConversionResult("Per pixel (scalar)", timer.Elapsed(), pixelCount, options.Iterations, checksum());
+		}
+
+		const std::pair<Utils::ToneMap, const char*> toneMaps[] = {
+			{Utils::ToneMap::None, "Span, no tone map"},
+			{Utils::ToneMap::Gamma, "Span, gamma"},
+			{Utils::ToneMap::Reinhard, "Span, Reinhard"},
+		};
+
+		for (const auto& [toneMap, name] : toneMaps)
+		{
+			Walnut::Timer timer;
+			for (uint32_t iteration = 0; iteration < options.Iterations; iteration++)
+			{
+				// Row by row, like the renderer.
+				for (uint32_t y = 0; y < options.Height; y++)
+				{
+					const size_t offset = static_cast<size_t>(y) * options.Width;
+					Utils::ConvertToRGBA(std::span(colors).subspan(offset, options.Width),
+						std::span(output).subspan(offset, options.Width), 1.0f / frameCount, toneMap);
+				}
+			}
+
+			PrintConversionResult(name, timer.Elapsed(), pixelCount, options.Iterations, checksum());
+		}
+	}
+
+	struct Integrator
+	{
+		const char* Name;
+		bool UseBsdfSampling;
+		bool UseRussianRoulette;
+	};
+
+	void SetupIntegrator(Renderer& renderer, Camera& camera, const Benchmark::Options& options,
+		const ReferenceScene& reference, const Integrator& integrator, uint32_t seed)
+	{
+		renderer.Bounces = options.ConvergenceBounces;
+		renderer.BackColor = {0.6f, 0.7f, 0.9f};
+		renderer.IsMultiThread = true;
+		renderer.GetSettings().Seed = seed;
+		renderer.GetSettings().UseBsdfSampling = integrator.UseBsdfSampling;
+		renderer.GetSettings().UseRussianRoulette = integrator.UseRussianRoulette;
+		renderer.OnResize(options.ConvergenceWidth, options.ConvergenceHeight);
+
+		camera.OnResize(options.ConvergenceWidth, options.ConvergenceHeight);
+		camera.SetView(reference.CameraPosition, reference.CameraDirection);
+	}
+
+	float ComputeRmse(const Renderer& renderer, const std::vector<glm::vec4>& reference)
+	{
+		const glm::vec4* accumulationData = renderer.GetAccumulationData();
+		const float scale = 1.0f / static_cast<float>(renderer.GetAccumulatedSampleCount());
+
+		double squaredError = 0.0;
+		for (size_t i = 0; i < reference.size(); i++)
+		{
+			const glm::vec3 difference = glm::vec3(accumulationData[i]) * scale - glm::vec3(reference[i]);
+			squaredError += glm::dot(difference, difference);
+		}
+
+		return static_cast<float>(std::sqrt(squaredError / static_cast<double>(reference.size() * 3)));
+	}
+
+	void RunIntegratorBenchmark(const Benchmark::Options& options)
+	{
+		const Integrator integrators[] = {
+			{"Legacy", false, false},
+			{"BSDF", true, false},
+			{"BSDF + roulette", true, true},
+		};
+
+		std::printf("\nIntegrators, %ux%u, %d bounces, target rmse %.3f against %u samples\n",
+			options.ConvergenceWidth, options.ConvergenceHeight, options.ConvergenceBounces, options.TargetRmse, options.ReferenceSamples);
+		std::printf("%-10s %-18s %10s %12s %14s %12s %10s\n",
+			"Scene", "Integrator", "Mrays/s", "rays/sample", "samples", "ms", "rmse");
+
+		for (const ReferenceScene& reference : ReferenceScene::CreateAll())
+		{
+			for (const Integrator& integrator : integrators)
+			{
+				// Every integrator converges to its own image, compare it against its own reference.
+				Renderer referenceRenderer(true);
+				Camera referenceCamera(45.0f, 0.1f, 100.0f);
+				SetupIntegrator(referenceRenderer, referenceCamera, options, reference, integrator, 0xbe9c4u);
+				for (uint32_t sample = 0; sample < options.ReferenceSamples; sample++)
+				{
+					referenceRenderer.Render(reference.ReferenceSceneData, referenceCamera);
+				}
+
+				const size_t pixelCount = static_cast<size_t>(options.ConvergenceWidth) * options.ConvergenceHeight;
+				std::vector<glm::vec4> referenceImage(referenceRenderer.GetAccumulationData(), referenceRenderer.GetAccumulationData() + pixelCount);
+				for (glm::vec4& pixel : referenceImage)
+				{
+					pixel /= static_cast<float>(referenceRenderer.GetAccumulatedSampleCount());
+				}
+
+				Renderer renderer(true);
+				Camera camera(45.0f, 0.1f, 100.0f);
+				SetupIntegrator(renderer, camera, options, reference, integrator, 1);
+
+				uint64_t rayCount = 0;
+				double seconds = 0.0;
+				float rmse = 0.0f;
+				uint32_t sampleCount = 0;
+				while (sampleCount < options.MaxSamples)
+				{
+					Walnut::Timer timer;
+					renderer.Render(reference.ReferenceSceneData, camera);
+					seconds += timer.Elapsed();
+					rayCount += renderer.GetRayCount();
+					sampleCount++;
+
+					rmse = ComputeRmse(renderer, referenceImage);
+					if (rmse <= options.TargetRmse)
+					{
+						break;
+					}
+				}
+
+				const bool hasConverged = rmse <= options.TargetRmse;
+				char samples[32];
+				std::snprintf(samples, sizeof(samples), hasConverged ? "%u" : ">%u", sampleCount);
+				std::printf("%-10s %-18s %10.2f %12.2f %14s %12.1f %10.4f\n",
+					reference.Name.c_str(), integrator.Name, rayCount / seconds * 1e-6,
+					static_cast<double>(rayCount) / (static_cast<double>(pixelCount) * sampleCount),
+					samples, seconds * 1000.0, rmse);
+			}
+		}
+	}
+
+	Scene CreateSphereCloud(uint32_t sphereCount)
+	{
+		Scene scene;
+		for (int i = 0; i < 8; i++)
+		{
+			Material& material = scene.Materials.emplace_back();
+			material.Albedo = glm::vec3(0.3f + 0.08f * i, 0.7f, 0.9f - 0.1f * i);
+			material.Roughness = 0.15f * i;
+			material.Metallic = i % 3 == 0 ? 1.0f : 0.0f;
+		}
+
+		// Spread over a fixed volume so the image stays similar while the count grows.
+		uint32_t seed = 42;
+		const float radius = 2.0f / std::cbrt(static_cast<float>(sphereCount));
+		for (uint32_t i = 0; i < sphereCount; i++)
+		{
+			Sphere& sphere = scene.Spheres.emplace_back();
+			sphere.Position = Utils::RandomVec3(seed, -2.0f, 2.0f);
+			sphere.Radius = radius * (0.5f + Utils::RandomFloat(seed));
+			sphere.MaterialIndex = static_cast<int>(i % scene.Materials.size());
+		}
+
+		return scene;
+	}
+
+	void RunSphereLayoutBenchmark(const Benchmark::Options& options)
+	{
+		constexpr double BytesPer100k = 100000.0 / 1024.0;
+		std::printf("\nSphere layout, bytes the intersection loop streams through\n");
+		std::printf("%-28s %10s %16s\n", "Layout", "bytes", "KiB/100k spheres");
+		std::printf("%-28s %10zu %16.1f\n", "Sphere (AoS)", sizeof(Sphere), sizeof(Sphere) * BytesPer100k);
+		std::printf("%-28s %10zu %16.1f\n", "Compact center + radius", sizeof(CompactSpheres::CenterRadius),
+			sizeof(CompactSpheres::CenterRadius) * BytesPer100k);
+		std::printf("%-28s %10zu %16.1f\n", "Compact material IDs (cold)", sizeof(uint32_t), sizeof(uint32_t) * BytesPer100k);
+
+		std::printf("\nSphere layout throughput, %ux%u, %u frames\n", options.LayoutWidth, options.LayoutHeight, options.LayoutFrames);
+		std::printf("%-10s %-10s %12s %12s %10s %14s %10s\n", "Spheres", "Layout", "KiB/ray", "ms/frame", "Mrays/s", "Gtests/s", "speedup");
+
+		for (const uint32_t sphereCount : {1000u, 10000u, 100000u})
+		{
+			// Both layouts render the same snapshot, which packs the spheres once.
+			const SceneEditor sceneEditor(CreateSphereCloud(sphereCount));
+			double baseSeconds = 0.0;
+			for (const bool isCompact : {false, true})
+			{
+				const size_t hotBytes = isCompact ? sceneEditor.GetSnapshot()->Compact->GetHotBytes() : sphereCount * sizeof(Sphere);
+
+				Renderer renderer(true);
+				renderer.Bounces = 2;
+				renderer.IsMultiThread = true;
+				renderer.IsCompactGeometry = isCompact;
+				renderer.OnResize(options.LayoutWidth, options.LayoutHeight);
+
+				Camera camera(45.0f, 0.1f, 100.0f);
+				camera.OnResize(options.LayoutWidth, options.LayoutHeight);
+				camera.SetView({0.0f, 0.0f, 6.0f}, {0.0f, 0.0f, -1.0f});
+
+				uint64_t rayCount = 0;
+				Walnut::Timer timer;
+				for (uint32_t frame = 0; frame < options.LayoutFrames; frame++)
+				{
+					renderer.Render(sceneEditor.GetSnapshot(), camera);
+					rayCount += renderer.GetRayCount();
+				}
+
+				const double seconds = timer.Elapsed();
+				baseSeconds = isCompact ? baseSeconds : seconds;
+				std::printf("%-10u %-10s %12.1f %12.2f %10.3f %14.3f %9.2fx\n",
+					sphereCount, isCompact ? "Compact" : "AoS", hotBytes / 1024.0, seconds * 1000.0 / options.LayoutFrames, rayCount / seconds * 1e-6,
+					static_cast<double>(rayCount) * sphereCount / seconds * 1e-9, baseSeconds / seconds);
+			}
+		}
+	}
+
+	void RunBackendBenchmark(const Benchmark::Options& options)
+	{
+		std::vector<ReferenceScene> scenes = ReferenceScene::CreateAll();
+		scenes.push_back({"cloud", CreateSphereCloud(options.BackendSphereCount), {0.0f, 0.0f, 6.0f}, {0.0f, 0.0f, -1.0f}});
+
+		std::printf("\nBackends, %ux%u, %u frames, %u spheres in the cloud\n",
+			options.BackendWidth, options.BackendHeight, options.BackendFrames, options.BackendSphereCount);
+		std::printf("%-10s %-12s %12s %10s %10s   %s\n", "Scene", "Backend", "ms/frame", "Mrays/s", "speedup", "image");
+
+		const size_t pixelCount = static_cast<size_t>(options.BackendWidth) * options.BackendHeight;
+		for (const ReferenceScene& reference : scenes)
+		{
+			double baseSeconds = 0.0;
+			std::vector<glm::vec4> baseImage;
+			for (const std::string& backendName : RenderBackendRegistry::GetNames())
+			{
+				Renderer renderer(true);
+				renderer.SetBackend(backendName);
+				renderer.Bounces = 4;
+				renderer.BackColor = {0.6f, 0.7f, 0.9f};
+				renderer.IsMultiThread = true;
+				renderer.GetSettings().Seed = 1;
+				renderer.OnResize(options.BackendWidth, options.BackendHeight);
+
+				Camera camera(45.0f, 0.1f, 100.0f);
+				camera.OnResize(options.BackendWidth, options.BackendHeight);
+				camera.SetView(reference.CameraPosition, reference.CameraDirection);
+
+				uint64_t rayCount = 0;
+				Walnut::Timer timer;
+				for (uint32_t frame = 0; frame < options.BackendFrames; frame++)
+				{
+					renderer.Render(reference.ReferenceSceneData, camera);
+					rayCount += renderer.GetRayCount();
+				}
+
+				const double seconds = timer.Elapsed();
+				const std::vector<glm::vec4> image(renderer.GetAccumulationData(), renderer.GetAccumulationData() + pixelCount);
+
+				// The first backend is the reference the others are timed and checked against.
+				if (baseImage.empty())
+				{
+					baseSeconds = seconds;
+					baseImage = image;
+				}
+
+				std::printf("%-10s %-12s %12.2f %10.2f %9.2fx   %s\n",
+					reference.Name.c_str(), backendName.c_str(), seconds * 1000.0 / options.BackendFrames,
+					rayCount / seconds * 1e-6, baseSeconds / seconds, image == baseImage ? "identical" : "DIFFERS");
+			}
+		}
+	}
+}
+
+int Benchmark::Run(const Options& options)
+{
+#if defined(_M_X64) || defined(__SSE2__)
+	std::printf("Vector path: %s\n", Utils::HasAvx2() ? "AVX2" : "SSE2");
+#else
+	std::printf("Vector path: scalar\n");
+#endif
+
+	RunConversionBenchmark(options);
+	RunIntegratorBenchmark(options);
+	RunSphereLayoutBenchmark(options);
+	RunBackendBenchmark(options);
+	return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// Headless performance measurements, results are printed as tables on stdout.
+class Benchmark
+{
+public:
+	struct Options
+	{
+		uint32_t Width = 1920;
+		uint32_t Height = 1080;
+		uint32_t Iterations = 50;
+
+		// Integrator convergence runs on the reference scenes, at a smaller size since they render a lot of samples.
+		uint32_t ConvergenceWidth = 320;
+		uint32_t ConvergenceHeight = 180;
+		int ConvergenceBounces = 8;
+		uint32_t ReferenceSamples = 256;
+		uint32_t MaxSamples = 128;
+		// RMSE against the converged reference that counts as noise free enough.
+		float TargetRmse = 0.03f;
+
+		// Sphere layout comparison, tiny frames since every ray tests every sphere.
+		uint32_t LayoutWidth = 64;
+		uint32_t LayoutHeight = 36;
+		uint32_t LayoutFrames = 2;
+
+		// Every registered backend renders the reference scenes and a sphere cloud.
+		uint32_t BackendWidth = 160;
+		uint32_t BackendHeight = 90;
+		uint32_t BackendFrames = 4;
+		uint32_t BackendSphereCount = 2000;
+	};
+
+public:
+	// Returns the process exit code.
+	static int Run(const Options& options);
+};
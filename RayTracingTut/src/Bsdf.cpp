@@ -0,0 +1,132 @@
+#include "Bsdf.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "Scene.h"
+#include "Utils.h"
+
+namespace
+{
+	// Reflectance of dielectrics at normal incidence.
+	constexpr float DielectricSpecular = 0.04f;
+	// Perfect mirrors would make GGX a delta, keep a tiny lobe instead.
+	constexpr float MinAlpha = 0.02f;
+	// Keeps the sample weights finite when a lobe is picked that almost never is.
+	constexpr float MinLobeProbability = 1e-4f;
+}
+
+Bsdf::Bsdf(const Material& material, const glm::vec3& normal, const glm::vec3& viewDirection, float minRoughness)
+	: _normal(normal),
+	_viewDirection(viewDirection),
+	_normalDotView(glm::max(glm::dot(normal, viewDirection), 1e-4f))
+{
+	// Branchless orthonormal basis (Duff et al. 2017).
+	const float sign = normal.z >= 0.0f ? 1.0f : -1.0f;
+	const float a = -1.0f / (sign + normal.z);
+	const float b = normal.x * normal.y * a;
+	_tangent = glm::vec3(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+	_bitangent = glm::vec3(b, sign + normal.y * normal.y * a, -normal.y);
+
+	const float metallic = glm::clamp(material.Metallic, 0.0f, 1.0f);
+	// Light reflected by the dielectric coat does not reach the diffuse layer.
+	_diffuseColor = material.Albedo * ((1.0f - metallic) * (1.0f - DielectricSpecular));
+	_specularColor = glm::mix(glm::vec3(DielectricSpecular), material.Albedo, metallic);
+	const float roughness = glm::max(material.Roughness, minRoughness);
+	_alpha = glm::max(roughness * roughness, MinAlpha);
+
+	// Pick the lobe by how much each one reflects from this view, a fixed split gives fireflies at grazing angles.
+	const glm::vec3 viewFresnel = Fresnel(_normalDotView);
+	const float specularWeight = viewFresnel.x + viewFresnel.y + viewFresnel.z;
+	const float diffuseWeight = _diffuseColor.x + _diffuseColor.y + _diffuseColor.z;
+	_specularProbability = specularWeight / (specularWeight + diffuseWeight);
+}
+
+Bsdf::Sample Bsdf::SampleDirection(uint32_t& seed) const
+{
+	Sample sample;
+	const float lobe = Utils::RandomFloat(seed);
+	const float u1 = Utils::RandomFloat(seed);
+	const float u2 = Utils::RandomFloat(seed);
+	const float phi = glm::two_pi<float>() * u1;
+
+	const float diffuseProbability = 1.0f - _specularProbability;
+	if (lobe < _specularProbability || diffuseProbability <= 0.0f)
+	{
+		// Sample the GGX half vector proportionally to D(h) * cos(h).
+		const float cosTheta = glm::sqrt((1.0f - u2) / (1.0f + (_alpha * _alpha - 1.0f) * u2));
+		const float sinTheta = glm::sqrt(glm::max(0.0f, 1.0f - cosTheta * cosTheta));
+		const glm::vec3 half = ToWorld({sinTheta * glm::cos(phi), sinTheta * glm::sin(phi), cosTheta});
+
+		const float viewDotHalf = glm::dot(_viewDirection, half);
+		sample.Direction = 2.0f * viewDotHalf * half - _viewDirection;
+		const float normalDotLight = glm::dot(_normal, sample.Direction);
+		if (viewDotHalf <= 0.0f || normalDotLight <= 0.0f)
+		{
+			return sample;
+		}
+
+		// f * cos / pdf simplifies to F * G * (v.h) / ((n.v) * (n.h)).
+		const float normalDotHalf = glm::max(cosTheta, 1e-4f);
+		const float geometry = Masking(_normalDotView) * Masking(normalDotLight);
+		sample.Weight = Fresnel(viewDotHalf)
+			* (geometry * viewDotHalf / (_normalDotView * normalDotHalf * glm::max(_specularProbability, MinLobeProbability)));
+		sample.IsSpecular = true;
+	}
+	else
+	{
+		// Cosine weighted hemisphere, f * cos / pdf is the diffuse color.
+		const float radius = glm::sqrt(u2);
+		sample.Direction = ToWorld({radius * glm::cos(phi), radius * glm::sin(phi), glm::sqrt(glm::max(0.0f, 1.0f - u2))});
+		sample.Weight = _diffuseColor / glm::max(diffuseProbability, MinLobeProbability);
+	}
+
+	sample.IsValid = true;
+	return sample;
+}
+
+glm::vec3 Bsdf::Evaluate(const glm::vec3& lightDirection) const
+{
+	const float normalDotLight = glm::dot(_normal, lightDirection);
+	if (normalDotLight <= 0.0f)
+	{
+		return glm::vec3(0.0f);
+	}
+
+	const glm::vec3 half = glm::normalize(lightDirection + _viewDirection);
+	const float normalDotHalf = glm::max(glm::dot(_normal, half), 0.0f);
+	const float viewDotHalf = glm::max(glm::dot(_viewDirection, half), 0.0f);
+
+	// D * G * F / (4 * (n.v) * (n.l)) times (n.l).
+	const glm::vec3 specular = Fresnel(viewDotHalf)
+		* (Distribution(normalDotHalf) * Masking(_normalDotView) * Masking(normalDotLight) / (4.0f * _normalDotView));
+	const glm::vec3 diffuse = _diffuseColor * (glm::one_over_pi<float>() * normalDotLight);
+	return diffuse + specular;
+}
+
+glm::vec3 Bsdf::ToWorld(const glm::vec3& local) const
+{
+	return _tangent * local.x + _bitangent * local.y + _normal * local.z;
+}
+
+glm::vec3 Bsdf::Fresnel(float cosTheta) const
+{
+	// Schlick's approximation
+	const float factor = glm::pow(1.0f - glm::clamp(cosTheta, 0.0f, 1.0f), 5.0f);
+	return _specularColor + (glm::vec3(1.0f) - _specularColor) * factor;
+}
+
+float Bsdf::Distribution(float normalDotHalf) const
+{
+	const float alpha2 = _alpha * _alpha;
+	const float denominator = normalDotHalf * normalDotHalf * (alpha2 - 1.0f) + 1.0f;
+	return alpha2 / (glm::pi<float>() * denominator * denominator);
+}
+
+float Bsdf::Masking(float normalDotDirection) const
+{
+	// Smith G1 for GGX
+	const float alpha2 = _alpha * _alpha;
+	const float cos2 = normalDotDirection * normalDotDirection;
+	return 2.0f * normalDotDirection / (normalDotDirection + glm::sqrt(alpha2 + (1.0f - alpha2) * cos2));
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+
+struct Material;
+
+// Surface scattering built from the Material fields: a cosine weighted diffuse lobe
+// and a GGX specular lobe, blended by Metallic.
+class Bsdf
+{
+public:
+	struct Sample
+	{
+		glm::vec3 Direction{0.0f};
+		// BSDF * cosine / pdf, what the path throughput gets multiplied by.
+		glm::vec3 Weight{0.0f};
+		bool IsSpecular = false;
+		bool IsValid = false;
+	};
+
+public:
+	// viewDirection points from the surface towards the viewer, normal faces the viewer.
+	// minRoughness widens sharp specular lobes, which keeps paths that are hard to sample from turning into fireflies.
+	Bsdf(const Material& material, const glm::vec3& normal, const glm::vec3& viewDirection, float minRoughness = 0.0f);
+
+	Sample SampleDirection(uint32_t& seed) const;
+	// BSDF * cosine towards lightDirection (pointing away from the surface).
+	glm::vec3 Evaluate(const glm::vec3& lightDirection) const;
+
+private:
+	glm::vec3 ToWorld(const glm::vec3& local) const;
+	glm::vec3 Fresnel(float cosTheta) const;
+	float Distribution(float normalDotHalf) const;
+	float Masking(float normalDotDirection) const;
+
+private:
+	glm::vec3 _normal;
+	glm::vec3 _tangent;
+	glm::vec3 _bitangent;
+	glm::vec3 _viewDirection;
+	float _normalDotView;
+
+	glm::vec3 _diffuseColor;
+	glm::vec3 _specularColor;
+	float _alpha;
+	float _specularProbability;
+};
@@ -102,6 +102,15 @@ void Camera::OnResize(uint32_t width, uint32_t height)
 	RecalculateRayDirections();
 }
 
+void Camera::SetView(const glm::vec3& position, const glm::vec3& forwardDirection)
+{
+	m_Position = position;
+	m_ForwardDirection = glm::normalize(forwardDirection);
+
+	RecalculateView();
+	RecalculateRayDirections();
+}
+
 float Camera::GetRotationSpeed()
 {
 	return 0.3f;
@@ -119,11 +128,23 @@ void Camera::RecalculateView()
 	m_InverseView = glm::inverse(m_View);
 }
 
+void Camera::ReplaceRayDirections()
+{
+	m_RayDirections = RayDirections();
+	RecalculateRayDirections();
+}
+
 void Camera::RecalculateRayDirections()
 {
-	m_RayDirections.resize(m_ViewportWidth * m_ViewportHeight);
+	const size_t size = static_cast<size_t>(m_ViewportWidth) * m_ViewportHeight;
+	if (m_RayDirections.size() != size)
+	{
+		// Fresh storage instead of resize, which would copy the old rows here and place their pages on this thread's node.
+		m_RayDirections = RayDirections();
+		m_RayDirections.resize(size);
+	}
 
-	for (uint32_t y = 0; y < m_ViewportHeight; y++)
+	const auto recalculateRow = [this](uint32_t y)
 	{
 		for (uint32_t x = 0; x < m_ViewportWidth; x++)
 		{
@@ -134,5 +155,16 @@ void Camera::RecalculateRayDirections()
 			glm::vec3 rayDirection = glm::vec3(m_InverseView * glm::vec4(glm::normalize(glm::vec3(target) / target.w), 0)); // World space
 			m_RayDirections[x + y * m_ViewportWidth] = rayDirection;
 		}
+	};
+
+	if (m_RowExecutor)
+	{
+		m_RowExecutor(m_ViewportHeight, recalculateRow);
+		return;
+	}
+
+	for (uint32_t y = 0; y < m_ViewportHeight; y++)
+	{
+		recalculateRow(y);
 	}
 }
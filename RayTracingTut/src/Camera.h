@@ -1,15 +1,24 @@
 #pragma once
 
+#include <functional>
 #include <glm/glm.hpp>
 #include <vector>
 
+#include "Utils.h"
+
 class Camera
 {
+public:
+	using RayDirections = std::vector<glm::vec3, DefaultInitAllocator<glm::vec3>>;
+	using RowExecutor = std::function<void(uint32_t height, const std::function<void(uint32_t)>& rowFunc)>;
+
 public:
 	Camera(float verticalFOV, float nearClip, float farClip);
 
 	bool OnUpdate(float ts);
 	void OnResize(uint32_t width, uint32_t height);
+	// Places the camera directly, used when it follows a path instead of the input.
+	void SetView(const glm::vec3& position, const glm::vec3& forwardDirection);
 
 	const glm::mat4& GetProjection() const { return m_Projection; }
 	const glm::mat4& GetInverseProjection() const { return m_InverseProjection; }
@@ -19,7 +28,12 @@ public:
 	const glm::vec3& GetPosition() const { return m_Position; }
 	const glm::vec3& GetDirection() const { return m_ForwardDirection; }
 
-	const std::vector<glm::vec3>& GetRayDirections() const { return m_RayDirections; }
+	const RayDirections& GetRayDirections() const { return m_RayDirections; }
+
+	// Lets the renderer compute ray directions on its own workers, so each row is first touched where it is traced.
+	void SetRowExecutor(RowExecutor rowExecutor) { m_RowExecutor = std::move(rowExecutor); }
+	// Moves the ray directions to fresh memory, call it when the executor starts placing rows differently.
+	void ReplaceRayDirections();
 
 	float GetRotationSpeed();
 private:
@@ -40,7 +54,8 @@ private:
 	glm::vec3 m_ForwardDirection{0.0f, 0.0f, 0.0f};
 
 	// Cached ray directions
-	std::vector<glm::vec3> m_RayDirections;
+	RayDirections m_RayDirections;
+	RowExecutor m_RowExecutor;
 
 	glm::vec2 m_LastMousePosition{ 0.0f, 0.0f };
 
@@ -0,0 +1,127 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <glm/glm.hpp>
+
+namespace
+{
+	glm::vec3 CatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t)
+	{
+		const float t2 = t * t;
+		const float t3 = t2 * t;
+		return 0.5f * (2.0f * p1
+			+ (p2 - p0) * t
+			+ (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2
+			+ (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+	}
+}
+
+void CameraPath::AddKeyframe(const Keyframe& keyframe)
+{
+	const auto it = std::upper_bound(_keyframes.begin(), _keyframes.end(), keyframe.Time,
+		[](float time, const Keyframe& other) { return time < other.Time; });
+	_keyframes.insert(it, keyframe);
+}
+
+CameraPath::Keyframe CameraPath::Evaluate(float time) const
+{
+	if (_keyframes.empty())
+	{
+		return {};
+	}
+
+	if (_keyframes.size() == 1 || time <= _keyframes.front().Time)
+	{
+		return _keyframes.front();
+	}
+
+	if (time >= _keyframes.back().Time)
+	{
+		return _keyframes.back();
+	}
+
+	const auto next = std::upper_bound(_keyframes.begin(), _keyframes.end(), time,
+		[](float value, const Keyframe& other) { return value < other.Time; });
+	const size_t i2 = static_cast<size_t>(next - _keyframes.begin());
+	const size_t i1 = i2 - 1;
+	const size_t i0 = i1 > 0 ? i1 - 1 : i1;
+	const size_t i3 = i2 + 1 < _keyframes.size() ? i2 + 1 : i2;
+
+	const Keyframe& k1 = _keyframes[i1];
+	const Keyframe& k2 = _keyframes[i2];
+	const float t = (time - k1.Time) / (k2.Time - k1.Time);
+
+	Keyframe result;
+	result.Time = time;
+	result.Position = CatmullRom(_keyframes[i0].Position, k1.Position, k2.Position, _keyframes[i3].Position, t);
+	result.Direction = glm::normalize(CatmullRom(_keyframes[i0].Direction, k1.Direction, k2.Direction, _keyframes[i3].Direction, t));
+	return result;
+}
+
+bool CameraPath::LoadFromFile(const std::filesystem::path& path)
+{
+	std::ifstream stream(path);
+	if (!stream)
+	{
+		return false;
+	}
+
+	std::vector<Keyframe> keyframes;
+	std::string line;
+	while (std::getline(stream, line))
+	{
+		line = line.substr(0, line.find('#'));
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+		{
+			continue;
+		}
+
+		std::istringstream lineStream(line);
+		Keyframe keyframe;
+		lineStream >> keyframe.Time
+			>> keyframe.Position.x >> keyframe.Position.y >> keyframe.Position.z
+			>> keyframe.Direction.x >> keyframe.Direction.y >> keyframe.Direction.z;
+		if (!lineStream)
+		{
+			return false;
+		}
+
+		keyframe.Direction = glm::normalize(keyframe.Direction);
+		keyframes.push_back(keyframe);
+	}
+
+	if (keyframes.empty())
+	{
+		return false;
+	}
+
+	_keyframes.clear();
+	for (const Keyframe& keyframe : keyframes)
+	{
+		AddKeyframe(keyframe);
+	}
+
+	return true;
+}
+
+bool CameraPath::SaveToFile(const std::filesystem::path& path) const
+{
+	std::ofstream stream(path);
+	if (!stream)
+	{
+		return false;
+	}
+
+	stream << "# time posX posY posZ dirX dirY dirZ\n";
+	for (const Keyframe& keyframe : _keyframes)
+	{
+		stream << keyframe.Time << ' '
+			<< keyframe.Position.x << ' ' << keyframe.Position.y << ' ' << keyframe.Position.z << ' '
+			<< keyframe.Direction.x << ' ' << keyframe.Direction.y << ' ' << keyframe.Direction.z << '\n';
+	}
+
+	return static_cast<bool>(stream);
+}
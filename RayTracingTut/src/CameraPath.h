@@ -0,0 +1,36 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include <glm/vec3.hpp>
+
+// Keyframed camera animation, positions and directions are interpolated with Catmull-Rom splines.
+class CameraPath
+{
+public:
+	struct Keyframe
+	{
+		float Time = 0.0f;
+		glm::vec3 Position{0.0f};
+		glm::vec3 Direction{0.0f, 0.0f, -1.0f};
+	};
+
+public:
+	void AddKeyframe(const Keyframe& keyframe);
+	void Clear() { _keyframes.clear(); }
+
+	// Samples the path, time is clamped to the first and last keyframes.
+	Keyframe Evaluate(float time) const;
+
+	float GetStartTime() const { return _keyframes.empty() ? 0.0f : _keyframes.front().Time; }
+	float GetEndTime() const { return _keyframes.empty() ? 0.0f : _keyframes.back().Time; }
+	const std::vector<Keyframe>& GetKeyframes() const { return _keyframes; }
+
+	// One keyframe per line: "time posX posY posZ dirX dirY dirZ", '#' starts a comment.
+	// Loading fails on a malformed line or a file without keyframes and keeps the current path.
+	bool LoadFromFile(const std::filesystem::path& path);
+	bool SaveToFile(const std::filesystem::path& path) const;
+
+private:
+	std::vector<Keyframe> _keyframes;
+};
@@ -0,0 +1,149 @@
+#include "CommandLine.h"
+
+#include <charconv>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "SequenceRenderer.h"
+
+namespace
+{
+	bool ParseUInt(std::string_view text, uint32_t& value)
+	{
+		const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+		return result.ec == std::errc() && result.ptr == text.data() + text.size();
+	}
+
+	bool ParseSize(std::string_view text, uint32_t& width, uint32_t& height)
+	{
+		const size_t separator = text.find('x');
+		return separator != std::string_view::npos
+			&& ParseUInt(text.substr(0, separator), width)
+			&& ParseUInt(text.substr(separator + 1), height)
+			&& width > 0 && height > 0;
+	}
+}
+
+CommandLine CommandLine::Parse(int argc, char** argv)
+{
+	CommandLine commandLine;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string_view argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+		const std::string_view value = hasValue ? argv[i + 1] : std::string_view();
+
+		bool isValid = true;
+		if (argument == "--numa")
+		{
+			commandLine.IsNumaAware = true;
+			continue;
+		}
+
+		if (argument == "--compact")
+		{
+			commandLine.IsCompactGeometry = true;
+			continue;
+		}
+
+		if (argument == "--legacy-shading")
+		{
+			commandLine.UseLegacyShading = true;
+			continue;
+		}
+
+		if (argument == "--no-roulette")
+		{
+			commandLine.UseRussianRoulette = false;
+			continue;
+		}
+
+		if (argument == "--benchmark")
+		{
+			commandLine.ShouldBenchmark = true;
+			continue;
+		}
+
+		if (argument == "--sequence" && hasValue)
+		{
+			commandLine.SequencePath = value;
+		}
+		else if (argument == "--backend" && hasValue)
+		{
+			commandLine.BackendName = value;
+			isValid = RenderBackendRegistry::Create(value) != nullptr;
+		}
+		else if (argument == "--output" && hasValue)
+		{
+			commandLine.OutputPattern = value;
+			isValid = SequenceRenderer::IsValidOutputPattern(value);
+		}
+		else if (argument == "--size" && hasValue)
+		{
+			isValid = ParseSize(value, commandLine.Width, commandLine.Height);
+		}
+		else if (argument == "--frames" && hasValue)
+		{
+			isValid = ParseUInt(value, commandLine.FrameCount) && commandLine.FrameCount > 0;
+		}
+		else if (argument == "--samples" && hasValue)
+		{
+			isValid = ParseUInt(value, commandLine.SamplesPerFrame) && commandLine.SamplesPerFrame > 0;
+		}
+		else if (argument == "--bounces" && hasValue)
+		{
+			uint32_t bounces = 0;
+			isValid = ParseUInt(value, bounces) && bounces > 0;
+			commandLine.Bounces = static_cast<int>(bounces);
+		}
+		else
+		{
+			std::fprintf(stderr, "Unknown or incomplete argument '%.*s'\n", static_cast<int>(argument.size()), argument.data());
+			commandLine.HasErrors = true;
+			continue;
+		}
+
+		if (!isValid)
+		{
+			std::fprintf(stderr, "Invalid value '%.*s' for '%.*s'\n",
+				static_cast<int>(value.size()), value.data(), static_cast<int>(argument.size()), argument.data());
+			commandLine.HasErrors = true;
+		}
+
+		i++;
+	}
+
+	return commandLine;
+}
+
+void CommandLine::PrintUsage()
+{
+	std::string backendNames;
+	for (const std::string& name : RenderBackendRegistry::GetNames())
+	{
+		backendNames += backendNames.empty() ? name : ", " + name;
+		if (name == RenderBackendRegistry::GetDefaultName())
+		{
+			backendNames += " (default)";
+		}
+	}
+
+	std::fprintf(stderr,
+		"Usage: RayTracingTut [options]\n"
+		"  --sequence <path>  Render the camera path file headless and exit\n"
+		"  --output <pattern> Output file pattern, std::format of the frame number (default frames/frame_{:04}.png)\n"
+		"                     .png and .ppm store the displayed image, .pfm the float accumulation\n"
+		"  --size <WxH>       Frame size (default 1280x720)\n"
+		"  --frames <n>       Number of frames (default 60)\n"
+		"  --samples <n>      Accumulated samples per frame (default 16)\n"
+		"  --bounces <n>      Ray bounces (default 2)\n"
+		"  --numa             Render on NUMA pinned workers\n"
+		"  --compact          Intersect packed 16 byte spheres, material IDs kept apart\n"
+		"  --legacy-shading   Use the original reflect-and-halve shading instead of BSDF sampling\n"
+		"  --no-roulette      Trace every path to --bounces instead of ending dim paths early\n"
+		"  --backend <name>   Render backend of the UI and --sequence: %s\n"
+		"  --benchmark        Print the benchmark tables at --size and exit\n",
+		backendNames.c_str());
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "RenderBackend.h"
+
+// Options for running without the UI, parsed from the process arguments.
+struct CommandLine
+{
+	// Camera path of a sequence render, empty when the UI should start.
+	std::filesystem::path SequencePath;
+	std::string OutputPattern = "frames/frame_{:04}.png";
+	uint32_t Width = 1280;
+	uint32_t Height = 720;
+	uint32_t FrameCount = 60;
+	uint32_t SamplesPerFrame = 16;
+	int Bounces = 2;
+	bool IsNumaAware = false;
+	bool IsCompactGeometry = false;
+	bool UseLegacyShading = false;
+	bool UseRussianRoulette = true;
+	// One of RenderBackendRegistry::GetNames().
+	std::string BackendName = RenderBackendRegistry::GetDefaultName();
+
+	// Runs the benchmarks at the --size resolution.
+	bool ShouldBenchmark = false;
+
+	bool HasErrors = false;
+
+	bool IsHeadless() const { return !SequencePath.empty() || ShouldBenchmark; }
+
+	static CommandLine Parse(int argc, char** argv);
+	static void PrintUsage();
+};
@@ -0,0 +1,30 @@
+#include "CompactSpheres.h"
+
+static_assert(sizeof(CompactSpheres::CenterRadius) == 16, "center and radius should fill exactly one 16 byte slot");
+
+void CompactSpheres::Build(const Scene& scene)
+{
+	Geometry.resize(scene.Spheres.size());
+	MaterialIds.resize(scene.Spheres.size());
+	for (size_t i = 0; i < scene.Spheres.size(); i++)
+	{
+		PackSphere(scene, static_cast<uint32_t>(i));
+	}
+}
+
+void CompactSpheres::Update(const Scene& scene, std::span<const uint32_t> sphereIndices)
+{
+	for (const uint32_t index : sphereIndices)
+	{
+		PackSphere(scene, index);
+	}
+}
+
+void CompactSpheres::PackSphere(const Scene& scene, uint32_t index)
+{
+	const Sphere& sphere = scene.Spheres[index];
+	Geometry[index] = {sphere.Position, sphere.Radius};
+
+	const bool isValidMaterial = sphere.MaterialIndex >= 0 && sphere.MaterialIndex < static_cast<int>(scene.Materials.size());
+	MaterialIds[index] = isValidMaterial ? static_cast<uint32_t>(sphere.MaterialIndex) : InvalidMaterial;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <glm/vec3.hpp>
+
+#include "Scene.h"
+
+// Sphere data split by how often it is read. The intersection loop only streams through the packed
+// center and radius, material IDs sit in their own array and are read once a hit gets shaded.
+struct CompactSpheres
+{
+	struct alignas(16) CenterRadius
+	{
+		glm::vec3 Center{0.0f};
+		float Radius = 0.0f;
+	};
+
+	// Material ID of spheres whose MaterialIndex is out of range, validated once instead of every bounce.
+	static constexpr uint32_t InvalidMaterial = ~0u;
+
+	std::vector<CenterRadius> Geometry;
+	std::vector<uint32_t> MaterialIds;
+
+	void Build(const Scene& scene);
+	// Repacks the given spheres after they moved or changed material.
+	void Update(const Scene& scene, std::span<const uint32_t> sphereIndices);
+
+	// Bytes the intersection loop streams through per ray.
+	size_t GetHotBytes() const { return Geometry.size() * sizeof(CenterRadius); }
+
+private:
+	void PackSphere(const Scene& scene, uint32_t index);
+};
@@ -0,0 +1,424 @@
+#include "ImageEncoders.h"
+
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	constexpr uint32_t WindowSize = 32768;
+	constexpr uint32_t HashBits = 15;
+	constexpr uint32_t MinMatch = 3;
+	constexpr uint32_t MaxMatch = 258;
+	constexpr uint32_t MaxChainLength = 32;
+	constexpr size_t ChunkSize = 64 * 1024;
+
+	constexpr std::array<uint16_t, 29> LengthBase = {
+		3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+	constexpr std::array<uint8_t, 29> LengthExtra = {
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+	constexpr std::array<uint16_t, 30> DistanceBase = {
+		1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+	constexpr std::array<uint8_t, 30> DistanceExtra = {
+		0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+	constexpr std::array<uint32_t, 256> MakeCrcTable()
+	{
+		std::array<uint32_t, 256> table{};
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; bit++)
+			{
+				crc = (crc & 1) ? 0xedb88320u ^ (crc >> 1) : crc >> 1;
+			}
+
+			table[i] = crc;
+		}
+
+		return table;
+	}
+
+	constexpr std::array<uint32_t, 256> CrcTable = MakeCrcTable();
+
+	uint32_t UpdateCrc(uint32_t crc, const uint8_t* data, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			crc = CrcTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+		}
+
+		return crc;
+	}
+
+	void WriteBigEndian(std::ostream& stream, uint32_t value)
+	{
+		const char bytes[4] = {
+			static_cast<char>(value >> 24), static_cast<char>(value >> 16),
+			static_cast<char>(value >> 8), static_cast<char>(value)};
+		stream.write(bytes, 4);
+	}
+
+	uint32_t Hash(const uint8_t* data)
+	{
+		const uint32_t value = data[0] | (data[1] << 8) | (data[2] << 16);
+		return (value * 2654435761u) >> (32 - HashBits);
+	}
+
+	uint8_t Paeth(int left, int up, int upLeft)
+	{
+		const int estimate = left + up - upLeft;
+		const int distanceLeft = std::abs(estimate - left);
+		const int distanceUp = std::abs(estimate - up);
+		const int distanceUpLeft = std::abs(estimate - upLeft);
+		if (distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft)
+		{
+			return static_cast<uint8_t>(left);
+		}
+
+		return static_cast<uint8_t>(distanceUp <= distanceUpLeft ? up : upLeft);
+	}
+}
+
+PngEncoder::PngEncoder(std::ostream& stream)
+	: _stream(stream) {}
+
+void PngEncoder::Begin(uint32_t width, uint32_t height)
+{
+	_width = width;
+	_row.assign(static_cast<size_t>(width) * 3, 0);
+	_previousRow.assign(_row.size(), 0);
+	_filteredRow.assign(_row.size() + 1, 0);
+	_candidateRow.assign(_row.size() + 1, 0);
+
+	_history.clear();
+	_historyStart = 0;
+	_hashHead.assign(1u << HashBits, 0);
+	_hashPrevious.assign(WindowSize, 0);
+	_adlerA = 1;
+	_adlerB = 0;
+	_bitBuffer = 0;
+	_bitCount = 0;
+	_compressed.clear();
+
+	constexpr uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+	_stream.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+	uint8_t header[13] = {};
+	for (int i = 0; i < 4; i++)
+	{
+		header[i] = static_cast<uint8_t>(width >> (24 - i * 8));
+		header[4 + i] = static_cast<uint8_t>(height >> (24 - i * 8));
+	}
+
+	header[8] = 8; // Bit depth
+	header[9] = 2; // RGB
+	WriteChunk("IHDR", header, sizeof(header));
+
+	// zlib header: deflate with a 32K window, no preset dictionary.
+	_compressed.push_back(0x78);
+	_compressed.push_back(0x01);
+}
+
+void PngEncoder::WriteRow(const uint32_t* pixels)
+{
+	for (uint32_t x = 0; x < _width; x++)
+	{
+		_row[x * 3 + 0] = static_cast<uint8_t>(pixels[x]);
+		_row[x * 3 + 1] = static_cast<uint8_t>(pixels[x] >> 8);
+		_row[x * 3 + 2] = static_cast<uint8_t>(pixels[x] >> 16);
+	}
+
+	// Pick the filter with the smallest sum of absolute residuals, the usual PNG heuristic.
+	uint64_t bestScore = UINT64_MAX;
+	for (const uint8_t filter : {0, 1, 2, 4})
+	{
+		_candidateRow[0] = filter;
+		uint64_t score = 0;
+		for (size_t i = 0; i < _row.size(); i++)
+		{
+			const int left = i >= 3 ? _row[i - 3] : 0;
+			const int up = _previousRow[i];
+			const int upLeft = i >= 3 ? _previousRow[i - 3] : 0;
+
+			uint8_t predicted = 0;
+			switch (filter)
+			{
+			case 1: predicted = static_cast<uint8_t>(left); break;
+			case 2: predicted = static_cast<uint8_t>(up); break;
+			case 4: predicted = Paeth(left, up, upLeft); break;
+			default: break;
+			}
+
+			const auto residual = static_cast<uint8_t>(_row[i] - predicted);
+			_candidateRow[i + 1] = residual;
+			score += static_cast<uint64_t>(std::abs(static_cast<int8_t>(residual)));
+		}
+
+		if (score < bestScore)
+		{
+			bestScore = score;
+			std::swap(_filteredRow, _candidateRow);
+		}
+	}
+
+	std::swap(_row, _previousRow);
+	CompressRow(_filteredRow.data(), _filteredRow.size());
+	FlushChunk(false);
+}
+
+void PngEncoder::End()
+{
+	// Final empty fixed Huffman block, then byte align and append the Adler-32 checksum.
+	WriteBits(1, 1);
+	WriteBits(1, 2);
+	WriteHuffman(0, 7);
+	FlushBits();
+
+	const uint32_t adler = (_adlerB << 16) | _adlerA;
+	for (int i = 0; i < 4; i++)
+	{
+		_compressed.push_back(static_cast<uint8_t>(adler >> (24 - i * 8)));
+	}
+
+	FlushChunk(true);
+	WriteChunk("IEND", nullptr, 0);
+	_stream.flush();
+}
+
+void PngEncoder::CompressRow(const uint8_t* data, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		_adlerA = (_adlerA + data[i]) % 65521;
+		_adlerB = (_adlerB + _adlerA) % 65521;
+	}
+
+	// Keep one window of history so matches can reach into previous rows.
+	if (_history.size() > 2 * WindowSize)
+	{
+		const size_t drop = _history.size() - WindowSize;
+		_history.erase(_history.begin(), _history.begin() + static_cast<std::ptrdiff_t>(drop));
+		_historyStart += drop;
+	}
+
+	const size_t begin = _history.size();
+	_history.insert(_history.end(), data, data + size);
+	const size_t end = _history.size();
+
+	// Every row is its own non-final fixed Huffman block, so the encoder never holds more than a row.
+	WriteBits(0, 1);
+	WriteBits(1, 2);
+
+	const auto insertHash = [this, end](size_t position)
+	{
+		if (position + MinMatch > end)
+		{
+			return;
+		}
+
+		const uint64_t absolute = _historyStart + position;
+		const uint32_t hash = Hash(&_history[position]);
+		_hashPrevious[absolute % WindowSize] = _hashHead[hash];
+		_hashHead[hash] = static_cast<uint32_t>(absolute + 1);
+	};
+
+	size_t position = begin;
+	while (position < end)
+	{
+		uint32_t bestLength = 0;
+		uint32_t bestDistance = 0;
+		const uint32_t maxLength = static_cast<uint32_t>(std::min<size_t>(MaxMatch, end - position));
+		if (maxLength >= MinMatch)
+		{
+			const uint64_t absolute = _historyStart + position;
+			const uint64_t oldest = std::max<uint64_t>(_historyStart, absolute > WindowSize ? absolute - WindowSize : 0);
+			uint32_t candidate = _hashHead[Hash(&_history[position])];
+			for (uint32_t chain = 0; chain < MaxChainLength && candidate > 0; chain++)
+			{
+				const uint64_t candidateAbsolute = candidate - 1;
+				if (candidateAbsolute < oldest || candidateAbsolute >= absolute)
+				{
+					break;
+				}
+
+				const uint8_t* match = &_history[candidateAbsolute - _historyStart];
+				const uint8_t* current = &_history[position];
+				uint32_t length = 0;
+				while (length < maxLength && match[length] == current[length])
+				{
+					length++;
+				}
+
+				if (length > bestLength)
+				{
+					bestLength = length;
+					bestDistance = static_cast<uint32_t>(absolute - candidateAbsolute);
+					if (length == maxLength)
+					{
+						break;
+					}
+				}
+
+				candidate = _hashPrevious[candidateAbsolute % WindowSize];
+			}
+		}
+
+		if (bestLength >= MinMatch)
+		{
+			WriteMatch(bestLength, bestDistance);
+			for (uint32_t i = 0; i < bestLength; i++)
+			{
+				insertHash(position + i);
+			}
+
+			position += bestLength;
+		}
+		else
+		{
+			WriteLiteral(_history[position]);
+			insertHash(position);
+			position++;
+		}
+	}
+
+	// End of block
+	WriteHuffman(0, 7);
+}
+
+void PngEncoder::WriteBits(uint32_t value, uint32_t count)
+{
+	_bitBuffer |= static_cast<uint64_t>(value) << _bitCount;
+	_bitCount += count;
+	while (_bitCount >= 8)
+	{
+		_compressed.push_back(static_cast<uint8_t>(_bitBuffer));
+		_bitBuffer >>= 8;
+		_bitCount -= 8;
+	}
+}
+
+void PngEncoder::WriteHuffman(uint32_t code, uint32_t length)
+{
+	// Huffman codes are stored most significant bit first.
+	uint32_t reversed = 0;
+	for (uint32_t i = 0; i < length; i++)
+	{
+		reversed = (reversed << 1) | ((code >> i) & 1);
+	}
+
+	WriteBits(reversed, length);
+}
+
+void PngEncoder::WriteLiteral(uint8_t literal)
+{
+	if (literal < 144)
+	{
+		WriteHuffman(0x30 + literal, 8);
+	}
+	else
+	{
+		WriteHuffman(0x190 + (literal - 144), 9);
+	}
+}
+
+void PngEncoder::WriteMatch(uint32_t length, uint32_t distance)
+{
+	uint32_t lengthCode = 0;
+	while (lengthCode + 1 < LengthBase.size() && LengthBase[lengthCode + 1] <= length)
+	{
+		lengthCode++;
+	}
+
+	const uint32_t symbol = 257 + lengthCode;
+	if (symbol < 280)
+	{
+		WriteHuffman(symbol - 256, 7);
+	}
+	else
+	{
+		WriteHuffman(0xc0 + (symbol - 280), 8);
+	}
+
+	WriteBits(length - LengthBase[lengthCode], LengthExtra[lengthCode]);
+
+	uint32_t distanceCode = 0;
+	while (distanceCode + 1 < DistanceBase.size() && DistanceBase[distanceCode + 1] <= distance)
+	{
+		distanceCode++;
+	}
+
+	WriteHuffman(distanceCode, 5);
+	WriteBits(distance - DistanceBase[distanceCode], DistanceExtra[distanceCode]);
+}
+
+void PngEncoder::FlushBits()
+{
+	if (_bitCount > 0)
+	{
+		_compressed.push_back(static_cast<uint8_t>(_bitBuffer));
+	}
+
+	_bitBuffer = 0;
+	_bitCount = 0;
+}
+
+void PngEncoder::FlushChunk(bool force)
+{
+	if (_compressed.empty() || (!force && _compressed.size() < ChunkSize))
+	{
+		return;
+	}
+
+	WriteChunk("IDAT", _compressed.data(), _compressed.size());
+	_compressed.clear();
+}
+
+void PngEncoder::WriteChunk(const char* type, const uint8_t* data, size_t size)
+{
+	WriteBigEndian(_stream, static_cast<uint32_t>(size));
+	_stream.write(type, 4);
+	if (size > 0)
+	{
+		_stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+	}
+
+	uint32_t crc = UpdateCrc(0xffffffffu, reinterpret_cast<const uint8_t*>(type), 4);
+	crc = UpdateCrc(crc, data, size);
+	WriteBigEndian(_stream, crc ^ 0xffffffffu);
+}
+
+PfmEncoder::PfmEncoder(std::ostream& stream)
+	: _stream(stream) {}
+
+void PfmEncoder::Begin(uint32_t width, uint32_t height)
+{
+	_width = width;
+	_row.resize(static_cast<size_t>(width) * 3);
+
+	// A negative scale marks little-endian samples.
+	const float endianScale = std::endian::native == std::endian::little ? -1.0f : 1.0f;
+	_stream << "PF\n" << width << ' ' << height << '\n' << endianScale << '\n';
+}
+
+void PfmEncoder::WriteRow(const float* pixels, float scale)
+{
+	for (uint32_t x = 0; x < _width; x++)
+	{
+		_row[x * 3 + 0] = pixels[x * 4 + 0] * scale;
+		_row[x * 3 + 1] = pixels[x * 4 + 1] * scale;
+		_row[x * 3 + 2] = pixels[x * 4 + 2] * scale;
+	}
+
+	_stream.write(reinterpret_cast<const char*>(_row.data()), static_cast<std::streamsize>(_row.size() * sizeof(float)));
+}
+
+void PfmEncoder::End()
+{
+	_stream.flush();
+}
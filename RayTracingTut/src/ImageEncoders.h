@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Streaming image encoders, every row is encoded as soon as it is written.
+
+// 8-bit RGB PNG written top row first, deflated with fixed Huffman codes into IDAT chunks as rows come in.
+class PngEncoder
+{
+public:
+	explicit PngEncoder(std::ostream& stream);
+
+	void Begin(uint32_t width, uint32_t height);
+	// Packed RGBA pixels (as produced by Utils::ConvertToRGBA), alpha is dropped.
+	void WriteRow(const uint32_t* pixels);
+	void End();
+
+private:
+	void CompressRow(const uint8_t* data, size_t size);
+	void WriteBits(uint32_t value, uint32_t count);
+	void WriteHuffman(uint32_t code, uint32_t length);
+	void WriteLiteral(uint8_t literal);
+	void WriteMatch(uint32_t length, uint32_t distance);
+	void FlushBits();
+	void FlushChunk(bool force);
+	void WriteChunk(const char* type, const uint8_t* data, size_t size);
+
+private:
+	std::ostream& _stream;
+	uint32_t _width = 0;
+
+	std::vector<uint8_t> _row;
+	std::vector<uint8_t> _previousRow;
+	std::vector<uint8_t> _filteredRow;
+	std::vector<uint8_t> _candidateRow;
+
+	// LZ77 history, positions are absolute offsets into the uncompressed stream.
+	std::vector<uint8_t> _history;
+	uint64_t _historyStart = 0;
+	std::vector<uint32_t> _hashHead;
+	std::vector<uint32_t> _hashPrevious;
+
+	uint32_t _adlerA = 1;
+	uint32_t _adlerB = 0;
+
+	uint64_t _bitBuffer = 0;
+	uint32_t _bitCount = 0;
+	std::vector<uint8_t> _compressed;
+};
+
+// 32-bit float RGB PFM, which stores the bottom row first like the renderer.
+class PfmEncoder
+{
+public:
+	explicit PfmEncoder(std::ostream& stream);
+
+	void Begin(uint32_t width, uint32_t height);
+	// RGBA floats, alpha is dropped.
+	void WriteRow(const float* pixels, float scale = 1.0f);
+	void End();
+
+private:
+	std::ostream& _stream;
+	uint32_t _width = 0;
+	std::vector<float> _row;
+};
@@ -0,0 +1,217 @@
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <string>
+
+#include "ImageEncoders.h"
+
+ImageWriter::ImageWriter(size_t maxPendingImages)
+	: _maxPendingImages(maxPendingImages > 0 ? maxPendingImages : 1),
+	_thread(&ImageWriter::WriterLoop, this) {}
+
+ImageWriter::~ImageWriter()
+{
+	Flush();
+	{
+		std::lock_guard lock(_mutex);
+		_isShuttingDown = true;
+	}
+
+	_jobCondition.notify_all();
+	_thread.join();
+}
+
+void ImageWriter::EnqueueHdr(std::filesystem::path path, uint32_t width, uint32_t height, std::vector<glm::vec4> pixels, float scale,
+	Utils::ToneMap toneMapping)
+{
+	Job job;
+	job.Path = std::move(path);
+	job.Width = width;
+	job.Height = height;
+	job.HdrPixels = std::move(pixels);
+	job.HdrScale = scale;
+	job.ToneMapping = toneMapping;
+	Push(std::move(job));
+}
+
+void ImageWriter::Push(Job job)
+{
+	{
+		std::unique_lock lock(_mutex);
+		_spaceCondition.wait(lock, [this] { return _jobs.size() < _maxPendingImages; });
+		_jobs.push_back(std::move(job));
+	}
+
+	_jobCondition.notify_one();
+}
+
+void ImageWriter::Flush()
+{
+	std::unique_lock lock(_mutex);
+	_spaceCondition.wait(lock, [this] { return _jobs.empty() && !_isWriting; });
+}
+
+void ImageWriter::WriterLoop()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock lock(_mutex);
+			_jobCondition.wait(lock, [this] { return _isShuttingDown || !_jobs.empty(); });
+			if (_jobs.empty())
+			{
+				return;
+			}
+
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+			_isWriting = true;
+		}
+
+		_spaceCondition.notify_all();
+
+		if (WriteFile(job))
+		{
+			_writtenCount++;
+		}
+		else
+		{
+			_failedCount++;
+		}
+
+		{
+			std::lock_guard lock(_mutex);
+			_isWriting = false;
+		}
+
+		_spaceCondition.notify_all();
+	}
+}
+
+bool ImageWriter::IsSupportedPath(const std::filesystem::path& path)
+{
+	return GetFormat(path) != Format::Unsupported;
+}
+
+ImageWriter::Format ImageWriter::GetFormat(const std::filesystem::path& path)
+{
+	std::string extension = path.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(),
+		[](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	if (extension == ".png")
+	{
+		return Format::Png;
+	}
+
+	if (extension == ".ppm")
+	{
+		return Format::Ppm;
+	}
+
+	if (extension == ".pfm")
+	{
+		return Format::Pfm;
+	}
+
+	return Format::Unsupported;
+}
+
+bool ImageWriter::WriteFile(const Job& job)
+{
+	const Format format = GetFormat(job.Path);
+	if (format == Format::Unsupported)
+	{
+		return false;
+	}
+
+	if (job.Path.has_parent_path())
+	{
+		std::error_code error;
+		std::filesystem::create_directories(job.Path.parent_path(), error);
+	}
+
+	std::ofstream stream(job.Path, std::ios::binary);
+	if (!stream)
+	{
+		return false;
+	}
+
+	switch (format)
+	{
+	case Format::Png:
+		WritePng(job, stream);
+		break;
+	case Format::Ppm:
+		WritePpm(job, stream);
+		break;
+	case Format::Pfm:
+		WritePfm(job, stream);
+		break;
+	case Format::Unsupported:
+		return false;
+	}
+
+	return static_cast<bool>(stream);
+}
+
+void ImageWriter::WritePng(const Job& job, std::ostream& stream)
+{
+	PngEncoder encoder(stream);
+	encoder.Begin(job.Width, job.Height);
+
+	// The renderer stores the bottom row first, PNG wants the top row first.
+	std::vector<uint32_t> row;
+	for (uint32_t y = job.Height; y-- > 0;)
+	{
+		encoder.WriteRow(PackRow(job, y, row));
+	}
+
+	encoder.End();
+}
+
+void ImageWriter::WritePpm(const Job& job, std::ostream& stream)
+{
+	stream << "P6\n" << job.Width << ' ' << job.Height << "\n255\n";
+
+	std::vector<char> row(job.Width * 3);
+	std::vector<uint32_t> packedRow;
+	for (uint32_t y = job.Height; y-- > 0;)
+	{
+		const uint32_t* pixels = PackRow(job, y, packedRow);
+		for (uint32_t x = 0; x < job.Width; x++)
+		{
+			row[x * 3 + 0] = static_cast<char>(pixels[x] & 0xff);
+			row[x * 3 + 1] = static_cast<char>((pixels[x] >> 8) & 0xff);
+			row[x * 3 + 2] = static_cast<char>((pixels[x] >> 16) & 0xff);
+		}
+
+		stream.write(row.data(), static_cast<std::streamsize>(row.size()));
+	}
+}
+
+const uint32_t* ImageWriter::PackRow(const Job& job, uint32_t y, std::vector<uint32_t>& row)
+{
+	// Same tone map and pack as the viewport.
+	const size_t offset = static_cast<size_t>(y) * job.Width;
+	row.resize(job.Width);
+	Utils::ConvertToRGBA(std::span(job.HdrPixels).subspan(offset, job.Width), row, job.HdrScale, job.ToneMapping);
+	return row.data();
+}
+
+void ImageWriter::WritePfm(const Job& job, std::ostream& stream)
+{
+	PfmEncoder encoder(stream);
+	encoder.Begin(job.Width, job.Height);
+
+	// PFM stores the bottom row first, same as the renderer.
+	for (uint32_t y = 0; y < job.Height; y++)
+	{
+		encoder.WriteRow(&job.HdrPixels[static_cast<size_t>(y) * job.Width].x, job.HdrScale);
+	}
+
+	encoder.End();
+}
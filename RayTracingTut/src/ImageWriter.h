@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/vec4.hpp>
+
+#include "Utils.h"
+
+// Background I/O thread that encodes and writes images so the render loop never waits on the disk.
+// The format follows the file extension, compared case-insensitively: .png, .ppm or .pfm.
+// Any other extension is rejected and counts as a failed write, nothing is written.
+class ImageWriter
+{
+public:
+	explicit ImageWriter(size_t maxPendingImages = 2);
+	~ImageWriter();
+
+	ImageWriter(const ImageWriter&) = delete;
+	ImageWriter& operator=(const ImageWriter&) = delete;
+
+	// Queues float pixels (bottom row first, like the renderer), blocks only when too many images are pending.
+	// Every channel is multiplied by scale while encoding.
+	// PFM keeps the floats, 8-bit formats are packed with Utils::ConvertToRGBA and the given tone map.
+	void EnqueueHdr(std::filesystem::path path, uint32_t width, uint32_t height, std::vector<glm::vec4> pixels, float scale = 1.0f,
+		Utils::ToneMap toneMapping = Utils::ToneMap::None);
+	// Blocks until every queued image is written.
+	void Flush();
+
+	uint32_t GetWrittenCount() const { return _writtenCount; }
+	uint32_t GetFailedCount() const { return _failedCount; }
+
+	static bool IsSupportedPath(const std::filesystem::path& path);
+
+private:
+	struct Job
+	{
+		std::filesystem::path Path;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		std::vector<glm::vec4> HdrPixels;
+		float HdrScale = 1.0f;
+		Utils::ToneMap ToneMapping = Utils::ToneMap::None;
+	};
+
+	enum class Format
+	{
+		Unsupported,
+		Png,
+		Ppm,
+		Pfm,
+	};
+
+	void Push(Job job);
+	void WriterLoop();
+	static Format GetFormat(const std::filesystem::path& path);
+	static bool WriteFile(const Job& job);
+	static void WritePng(const Job& job, std::ostream& stream);
+	static void WritePpm(const Job& job, std::ostream& stream);
+	static void WritePfm(const Job& job, std::ostream& stream);
+	static const uint32_t* PackRow(const Job& job, uint32_t y, std::vector<uint32_t>& row);
+
+private:
+	const size_t _maxPendingImages;
+
+	std::mutex _mutex;
+	std::condition_variable _jobCondition;
+	std::condition_variable _spaceCondition;
+	std::deque<Job> _jobs;
+	bool _isWriting = false;
+	bool _isShuttingDown = false;
+
+	std::atomic<uint32_t> _writtenCount = 0;
+	std::atomic<uint32_t> _failedCount = 0;
+
+	std::thread _thread;
+};
@@ -0,0 +1,195 @@
+#include "NumaWorkerPool.h"
+
+#ifdef WL_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+NumaWorkerPool::NumaWorkerPool()
+{
+	const std::vector<Core> cores = QueryCores();
+
+	_workers.reserve(cores.size());
+	for (const Core& core : cores)
+	{
+		_nodes[core.NodeSlot]->WorkerCount++;
+		_workers.emplace_back(&NumaWorkerPool::WorkerLoop, this, core);
+	}
+
+	_nodeStats.resize(_nodes.size());
+}
+
+NumaWorkerPool::~NumaWorkerPool()
+{
+	{
+		std::lock_guard lock(_mutex);
+		_isShuttingDown = true;
+	}
+
+	_wakeCondition.notify_all();
+	for (std::thread& worker : _workers)
+	{
+		worker.join();
+	}
+}
+
+void NumaWorkerPool::ForEachRow(uint32_t height, const RowFunc& rowFunc)
+{
+	if (height == 0)
+	{
+		return;
+	}
+
+	std::lock_guard callLock(_callMutex);
+
+	// Give every node a contiguous slice of rows proportional to its worker count.
+	const uint64_t totalWorkers = _workers.size();
+	uint64_t workersBefore = 0;
+	uint32_t rowBegin = 0;
+	for (const auto& node : _nodes)
+	{
+		workersBefore += node->WorkerCount;
+		node->RowBegin = rowBegin;
+		node->RowEnd = static_cast<uint32_t>(height * workersBefore / totalWorkers);
+		node->NextRow = node->RowBegin;
+		node->ActiveWorkers = node->WorkerCount;
+		rowBegin = node->RowEnd;
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+	_activeWorkers = static_cast<uint32_t>(totalWorkers);
+	{
+		std::lock_guard lock(_mutex);
+		_rowFunc = &rowFunc;
+		_generation++;
+	}
+
+	_wakeCondition.notify_all();
+
+	{
+		std::unique_lock lock(_mutex);
+		_doneCondition.wait(lock, [this] { return _activeWorkers == 0; });
+		_rowFunc = nullptr;
+	}
+
+	for (size_t i = 0; i < _nodes.size(); i++)
+	{
+		const NodeState& node = *_nodes[i];
+		NodeStats& stats = _nodeStats[i];
+		stats.Node = node.Id;
+		stats.WorkerCount = node.WorkerCount;
+		stats.RowCount = node.RowEnd - node.RowBegin;
+		stats.Milliseconds = std::chrono::duration<float, std::milli>(node.FinishTime - startTime).count();
+	}
+}
+
+std::vector<NumaWorkerPool::NodeStats> NumaWorkerPool::GetNodeStats() const
+{
+	std::lock_guard callLock(_callMutex);
+	return _nodeStats;
+}
+
+std::vector<NumaWorkerPool::Core> NumaWorkerPool::QueryCores()
+{
+	std::vector<Core> cores;
+
+#ifdef WL_PLATFORM_WINDOWS
+	ULONG highestNode = 0;
+	if (GetNumaHighestNodeNumber(&highestNode))
+	{
+		for (USHORT nodeId = 0; nodeId <= highestNode; nodeId++)
+		{
+			GROUP_AFFINITY affinity{};
+			if (!GetNumaNodeProcessorMaskEx(nodeId, &affinity) || affinity.Mask == 0)
+			{
+				continue;
+			}
+
+			const auto nodeSlot = static_cast<uint32_t>(_nodes.size());
+			auto& node = _nodes.emplace_back(std::make_unique<NodeState>());
+			node->Id = nodeId;
+
+			for (uint8_t bit = 0; bit < sizeof(KAFFINITY) * 8; bit++)
+			{
+				if (affinity.Mask & (static_cast<KAFFINITY>(1) << bit))
+				{
+					cores.push_back({affinity.Group, bit, nodeSlot});
+				}
+			}
+		}
+	}
+
+	_isPinned = !cores.empty();
+#endif
+
+	if (cores.empty())
+	{
+		// Unknown topology, behave like a single node with unpinned workers.
+		_nodes.clear();
+		_nodes.emplace_back(std::make_unique<NodeState>());
+
+		const uint32_t coreCount = std::max(1u, std::thread::hardware_concurrency());
+		for (uint32_t i = 0; i < coreCount; i++)
+		{
+			cores.push_back({0, static_cast<uint8_t>(i), 0});
+		}
+	}
+
+	return cores;
+}
+
+void NumaWorkerPool::PinCurrentThread([[maybe_unused]] const Core& core) const
+{
+	if (!_isPinned)
+	{
+		return;
+	}
+
+#ifdef WL_PLATFORM_WINDOWS
+	GROUP_AFFINITY affinity{};
+	affinity.Group = core.Group;
+	affinity.Mask = static_cast<KAFFINITY>(1) << core.Index;
+	SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+#endif
+}
+
+void NumaWorkerPool::WorkerLoop(Core core)
+{
+	PinCurrentThread(core);
+
+	NodeState& node = *_nodes[core.NodeSlot];
+	uint64_t seenGeneration = 0;
+	while (true)
+	{
+		const RowFunc* rowFunc = nullptr;
+		{
+			std::unique_lock lock(_mutex);
+			_wakeCondition.wait(lock, [this, seenGeneration] { return _isShuttingDown || _generation != seenGeneration; });
+			if (_isShuttingDown)
+			{
+				return;
+			}
+
+			seenGeneration = _generation;
+			rowFunc = _rowFunc;
+		}
+
+		// Only take rows from our own node's slice so its pages stay local.
+		for (uint32_t y = node.NextRow++; y < node.RowEnd; y = node.NextRow++)
+		{
+			(*rowFunc)(y);
+		}
+
+		if (--node.ActiveWorkers == 0)
+		{
+			node.FinishTime = std::chrono::steady_clock::now();
+		}
+
+		if (--_activeWorkers == 0)
+		{
+			std::lock_guard lock(_mutex);
+			_doneCondition.notify_one();
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent pool of render workers pinned to cores, grouped by NUMA node.
+// Rows are split into one contiguous slice per node so every node keeps touching the same memory.
+class NumaWorkerPool
+{
+public:
+	struct NodeStats
+	{
+		uint32_t Node = 0;
+		uint32_t WorkerCount = 0;
+		uint32_t RowCount = 0;
+		float Milliseconds = 0.0f;
+	};
+
+	using RowFunc = std::function<void(uint32_t)>;
+
+public:
+	NumaWorkerPool();
+	~NumaWorkerPool();
+
+	NumaWorkerPool(const NumaWorkerPool&) = delete;
+	NumaWorkerPool& operator=(const NumaWorkerPool&) = delete;
+
+	// Blocks until rowFunc ran for every row in [0, height).
+	// Calls from several threads are run one after another, the workers serve one call at a time.
+	void ForEachRow(uint32_t height, const RowFunc& rowFunc);
+
+	uint32_t GetNodeCount() const { return static_cast<uint32_t>(_nodes.size()); }
+	uint32_t GetWorkerCount() const { return static_cast<uint32_t>(_workers.size()); }
+	bool IsPinned() const { return _isPinned; }
+
+	// Stats of the last ForEachRow call, one entry per node.
+	std::vector<NodeStats> GetNodeStats() const;
+
+private:
+	struct Core
+	{
+		uint16_t Group = 0;
+		uint8_t Index = 0;
+		uint32_t NodeSlot = 0;
+	};
+
+	struct NodeState
+	{
+		uint32_t Id = 0;
+		uint32_t WorkerCount = 0;
+		uint32_t RowBegin = 0;
+		uint32_t RowEnd = 0;
+		std::atomic<uint32_t> NextRow = 0;
+		std::atomic<uint32_t> ActiveWorkers = 0;
+		std::chrono::steady_clock::time_point FinishTime;
+	};
+
+	std::vector<Core> QueryCores();
+	void PinCurrentThread(const Core& core) const;
+	void WorkerLoop(Core core);
+
+private:
+	std::vector<std::unique_ptr<NodeState>> _nodes;
+	std::vector<std::thread> _workers;
+	std::vector<NodeStats> _nodeStats;
+	bool _isPinned = false;
+
+	// Held for a whole ForEachRow call, guards the node slices and the stats.
+	mutable std::mutex _callMutex;
+	std::mutex _mutex;
+	std::condition_variable _wakeCondition;
+	std::condition_variable _doneCondition;
+	uint64_t _generation = 0;
+	bool _isShuttingDown = false;
+
+	const RowFunc* _rowFunc = nullptr;
+	std::atomic<uint32_t> _activeWorkers = 0;
+};
@@ -0,0 +1,277 @@
+#include "PathTracer.h"
+
+#include <limits>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "Bsdf.h"
+#include "Camera.h"
+#include "SceneSnapshot.h"
+#include "Utils.h"
+
+namespace
+{
+	// Offset along the normal so secondary rays don't hit the surface they start from.
+	constexpr float SurfaceOffset = 0.0001f;
+	// Specular lobes after a diffuse bounce are at least this rough, a sharp highlight of the sun seen
+	// through a diffuse bounce is only found by chance and shows up as fireflies.
+	constexpr float DiffusePathMinRoughness = 0.3f;
+	// Scales the directional light so a white diffuse surface facing it reflects 1.
+	const float LightIrradiance = glm::pi<float>();
+}
+
+PathTracer::PathTracer(const FrameContext& context)
+	: _context(context),
+	_lightDirection(glm::normalize(context.LightDirection)) {}
+
+PathTracer::Path PathTracer::BeginPath(uint32_t x, uint32_t y) const
+{
+	Path path;
+	path.CurrentRay.Origin = _context.FrameCamera->GetPosition();
+	path.CurrentRay.Direction = _context.FrameCamera->GetRayDirections()[x + y * _context.Width];
+	path.Seed = Utils::PCGHash(x + y * _context.Width) ^ Utils::PCGHash(_context.FrameIndex + _context.Seed * 0x9e3779b9u);
+	path.IsActive = _context.Bounces > 0;
+	return path;
+}
+
+PathTracer::ShadowRequest PathTracer::Shade(Path& path, const Hit& hit) const
+{
+	ShadowRequest shadow;
+	if (!hit.IsHit())
+	{
+		path.Color += _context.BackColor * path.Throughput;
+		path.IsActive = false;
+		return shadow;
+	}
+
+	const Material* material = GetMaterial(hit);
+	if (!material)
+	{
+		path.IsActive = false;
+		return shadow;
+	}
+
+	// Emissive surfaces are only found by hitting them, they are not sampled like the light.
+	path.Color += material->GetEmission() * path.Throughput;
+
+	const HitPayload payload = ClosestHit(path.CurrentRay, hit);
+	if (_context.UseBsdfSampling)
+	{
+		shadow = ShadeBsdf(path, payload, *material);
+	}
+	else
+	{
+		ShadeLegacy(path, payload, *material);
+	}
+
+	path.Bounce++;
+	if (path.Bounce >= _context.Bounces)
+	{
+		path.IsActive = false;
+	}
+
+	return shadow;
+}
+
+glm::vec4 PathTracer::TracePixel(uint32_t x, uint32_t y, uint32_t& rayCount) const
+{
+	Path path = BeginPath(x, y);
+	while (path.IsActive)
+	{
+		const Hit hit = TraceRay(path.CurrentRay);
+		rayCount++;
+
+		const ShadowRequest shadow = Shade(path, hit);
+		if (shadow.IsPending)
+		{
+			rayCount++;
+			if (!TraceRay(shadow.ShadowRay).IsHit())
+			{
+				path.Color += shadow.Contribution;
+			}
+		}
+	}
+
+	return glm::vec4(path.Color, 1.0f);
+}
+
+PathTracer::ShadowRequest PathTracer::ShadeBsdf(Path& path, const HitPayload& payload, const Material& material) const
+{
+	const glm::vec3 lightDir = -_lightDirection;
+
+	// Rays starting inside a sphere see its back faces, shade them as seen from the ray.
+	const glm::vec3 viewDir = -glm::normalize(path.CurrentRay.Direction);
+	const glm::vec3 normal = glm::dot(payload.WorldNormal, viewDir) < 0.0f ? -payload.WorldNormal : payload.WorldNormal;
+	const glm::vec3 origin = payload.WorldPosition + normal * SurfaceOffset;
+
+	const Bsdf bsdf(material, normal, viewDir, path.HasDiffuseBounce ? DiffusePathMinRoughness : 0.0f);
+
+	// Direct light, only lit if nothing blocks the way towards it.
+	ShadowRequest shadow;
+	const glm::vec3 direct = bsdf.Evaluate(lightDir);
+	if (direct.x + direct.y + direct.z > 0.0f)
+	{
+		shadow.ShadowRay = {origin, lightDir};
+		shadow.Contribution = direct * LightIrradiance * path.Throughput;
+		shadow.IsPending = true;
+	}
+
+	const Bsdf::Sample sample = bsdf.SampleDirection(path.Seed);
+	if (!sample.IsValid)
+	{
+		path.IsActive = false;
+		return shadow;
+	}
+
+	path.Throughput *= sample.Weight;
+	path.HasDiffuseBounce |= !sample.IsSpecular;
+
+	// Decides about every ray after the camera ray, so it works at the default two bounces.
+	// The last bounce ends the path anyway, a roulette there would only add noise.
+	const bool hasNextBounce = path.Bounce + 1 < _context.Bounces;
+	if (_context.UseRussianRoulette && hasNextBounce)
+	{
+		// Full throughput paths always survive, dim ones survive as often as their weight and come back at about 1.
+		const float survival = glm::min(1.0f, glm::max(path.Throughput.x, glm::max(path.Throughput.y, path.Throughput.z)));
+		if (Utils::RandomFloat(path.Seed) >= survival)
+		{
+			path.IsActive = false;
+			return shadow;
+		}
+
+		path.Throughput /= survival;
+	}
+
+	path.CurrentRay.Origin = origin;
+	path.CurrentRay.Direction = sample.Direction;
+	return shadow;
+}
+
+void PathTracer::ShadeLegacy(Path& path, const HitPayload& payload, const Material& material) const
+{
+	float lightIntensity = glm::max(0.0f, glm::dot(payload.WorldNormal, -_lightDirection));
+
+	auto sphereColor = material.Albedo;
+	sphereColor *= lightIntensity;
+
+	// The throughput stays gray here, it is the multiplier halving every bounce.
+	path.Color += sphereColor * path.Throughput;
+	path.Throughput *= 0.5f;
+
+	path.CurrentRay.Origin = payload.WorldPosition + payload.WorldNormal * SurfaceOffset;
+	path.CurrentRay.Direction = glm::reflect(path.CurrentRay.Direction,
+		payload.WorldNormal + material.Roughness * Utils::RandomVec3(path.Seed, -0.5f, 0.5f));
+}
+
+const Material* PathTracer::GetMaterial(const Hit& hit) const
+{
+	const std::vector<Material>& materials = *_context.Materials;
+	if (_context.Compact)
+	{
+		const uint32_t materialId = _context.Compact->MaterialIds[hit.ObjectIndex];
+		return materialId != CompactSpheres::InvalidMaterial ? &materials[materialId] : nullptr;
+	}
+
+	const Sphere& sphere = (*_context.Spheres)[hit.ObjectIndex];
+	if (sphere.MaterialIndex < 0 || sphere.MaterialIndex >= static_cast<int>(materials.size()))
+	{
+		return nullptr;
+	}
+
+	return &materials[sphere.MaterialIndex];
+}
+
+bool PathTracer::MayHitScene(const Ray& ray) const
+{
+	return !_context.Geometry || _context.Geometry->IntersectsScene(ray);
+}
+
+PathTracer::Hit PathTracer::TraceRay(const Ray& ray) const
+{
+	if (!MayHitScene(ray))
+	{
+		return {};
+	}
+
+	int closestSphere = -1;
+	float closestHit = std::numeric_limits<float>::max();
+	ForEachSphere([&](uint32_t index, const glm::vec3& center, float radius)
+	{
+		if (IntersectSphere(ray, center, radius, closestHit))
+		{
+			closestSphere = static_cast<int>(index);
+		}
+	});
+
+	if (closestSphere < 0)
+	{
+		return {};
+	}
+
+	return {closestHit, static_cast<uint32_t>(closestSphere)};
+}
+
+PathTracer::HitPayload PathTracer::ClosestHit(const Ray& ray, const Hit& hit) const
+{
+	HitPayload payload;
+	payload.HitDistance = hit.Distance;
+	payload.ObjectIndex = static_cast<int>(hit.ObjectIndex);
+
+	const glm::vec3 center = _context.Compact
+		? _context.Compact->Geometry[hit.ObjectIndex].Center
+		: (*_context.Spheres)[hit.ObjectIndex].Position;
+
+	const glm::vec3 rayOrigin = ray.Origin - center;
+
+	payload.WorldPosition = rayOrigin + ray.Direction * hit.Distance;
+	payload.WorldNormal = glm::normalize(payload.WorldPosition);
+	payload.WorldPosition += center;
+
+	return payload;
+}
+
+bool PathTracer::IntersectSphere(const Ray& ray, const Sphere& sphere, float& closestHit)
+{
+	return IntersectSphere(ray, sphere.Position, sphere.Radius, closestHit);
+}
+
+bool PathTracer::IntersectSphere(const Ray& ray, const glm::vec3& center, float radius, float& closestHit)
+{
+	const glm::vec3 rayOrigin = ray.Origin - center;
+	const float a = glm::dot(ray.Direction, ray.Direction);
+	const float b = 2.0f * glm::dot(rayOrigin, ray.Direction);
+	const float c = glm::dot(rayOrigin, rayOrigin) - radius * radius;
+
+	const float discriminant = b * b - 4.0f * a * c;
+
+	if (discriminant < 0.0f)
+	{
+		return false;
+	}
+
+	// Get the closest point on the sphere from the camera
+	float closestT = (-b - glm::sqrt(discriminant)) / (2.0f * a);
+	// Get the point the second intersection point after closest point.
+	float t0 = (-b + glm::sqrt(discriminant)) / (2.0f * a);
+
+	// If the closest point is negative it means it is behind the camera.
+	if (closestT < 0.0f)
+	{
+		// If the second point is also negative it means it is also behind the camera.
+		if (t0 < 0.0f)
+		{
+			return false;
+		}
+
+		// Else it means we are inside the sphere so we will use the second point.
+		closestT = t0;
+	}
+
+	if (closestT < closestHit)
+	{
+		closestHit = closestT;
+		return true;
+	}
+
+	return false;
+}
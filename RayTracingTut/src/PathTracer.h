@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "CompactSpheres.h"
+#include "Ray.h"
+#include "RenderBackend.h"
+#include "Scene.h"
+
+// The integrator, split into the steps of a path so backends can schedule them differently.
+// Driving a path through the same steps gives the same image, bit for bit.
+class PathTracer
+{
+public:
+	// What the intersection loop produces, shading computes the rest from it.
+	struct Hit
+	{
+		float Distance = -1.0f;
+		uint32_t ObjectIndex = 0;
+
+		bool IsHit() const { return Distance >= 0.0f; }
+	};
+
+	struct Path
+	{
+		Ray CurrentRay;
+		glm::vec3 Color{0.0f};
+		glm::vec3 Throughput{1.0f};
+		uint32_t Seed = 0;
+		int Bounce = 0;
+		bool HasDiffuseBounce = false;
+		bool IsActive = true;
+	};
+
+	// Direct light of a hit, added to the path color only if nothing blocks the shadow ray.
+	struct ShadowRequest
+	{
+		Ray ShadowRay;
+		glm::vec3 Contribution{0.0f};
+		bool IsPending = false;
+	};
+
+public:
+	explicit PathTracer(const FrameContext& context);
+
+	Path BeginPath(uint32_t x, uint32_t y) const;
+	// Shades the hit and moves the path to its next ray. Misses, spheres without a material,
+	// absorbed samples, Russian roulette and the bounce limit end the path.
+	ShadowRequest Shade(Path& path, const Hit& hit) const;
+
+	// All steps of one pixel in a row.
+	glm::vec4 TracePixel(uint32_t x, uint32_t y, uint32_t& rayCount) const;
+	Hit TraceRay(const Ray& ray) const;
+	// False when the ray cannot hit any sphere.
+	bool MayHitScene(const Ray& ray) const;
+
+	// Calls sphereFunc(index, center, radius) in index order, from the packed copy when there is one.
+	template<typename SphereFunc>
+	void ForEachSphere(SphereFunc&& sphereFunc) const
+	{
+		if (_context.Compact)
+		{
+			const std::vector<CompactSpheres::CenterRadius>& geometry = _context.Compact->Geometry;
+			for (size_t i = 0; i < geometry.size(); i++)
+			{
+				sphereFunc(static_cast<uint32_t>(i), geometry[i].Center, geometry[i].Radius);
+			}
+		}
+		else
+		{
+			const std::vector<Sphere>& spheres = *_context.Spheres;
+			for (size_t i = 0; i < spheres.size(); i++)
+			{
+				sphereFunc(static_cast<uint32_t>(i), spheres[i].Position, spheres[i].Radius);
+			}
+		}
+	}
+
+	static bool IntersectSphere(const Ray& ray, const Sphere& sphere, float& closestHit);
+	static bool IntersectSphere(const Ray& ray, const glm::vec3& center, float radius, float& closestHit);
+
+private:
+	struct HitPayload
+	{
+		float HitDistance;
+		glm::vec3 WorldPosition;
+		glm::vec3 WorldNormal;
+
+		int ObjectIndex;
+	};
+
+	ShadowRequest ShadeBsdf(Path& path, const HitPayload& payload, const Material& material) const;
+	void ShadeLegacy(Path& path, const HitPayload& payload, const Material& material) const;
+	const Material* GetMaterial(const Hit& hit) const;
+	HitPayload ClosestHit(const Ray& ray, const Hit& hit) const;
+
+private:
+	const FrameContext& _context;
+	glm::vec3 _lightDirection;
+};
@@ -0,0 +1,59 @@
+#include "ReferenceBackend.h"
+
+#include <execution>
+
+#include "PathTracer.h"
+
+void ReferenceBackend::RenderFrame(const FrameContext& context)
+{
+	const PathTracer pathTracer(context);
+
+	if (context.IsMultiThreadInner && _imageHorIter.size() != context.Width)
+	{
+		_imageHorIter.resize(context.Width);
+		for (uint32_t i = 0; i < context.Width; i++)
+		{
+			_imageHorIter[i] = i;
+		}
+	}
+
+	context.ForEachRow([this, &context, &pathTracer](uint32_t y)
+	{
+		if (context.IsMultiThreadInner)
+		{
+			std::for_each(std::execution::par, _imageHorIter.begin(), _imageHorIter.end(),
+				[this, &context, &pathTracer, y](uint32_t x)
+				{
+					RenderPixel(context, pathTracer, x, y);
+				});
+		}
+		else
+		{
+			RenderRow(context, pathTracer, y);
+		}
+	});
+}
+
+void ReferenceBackend::RenderRow(const FrameContext& context, const PathTracer& pathTracer, uint32_t y) const
+{
+	const uint32_t rowStart = y * context.Width;
+	uint64_t rayCount = 0;
+	for (uint32_t x = 0; x < context.Width; x++)
+	{
+		uint32_t pixelRayCount = 0;
+		context.Accumulate(rowStart + x, pathTracer.TracePixel(x, y, pixelRayCount));
+		rayCount += pixelRayCount;
+	}
+
+	context.RayCount->fetch_add(rayCount, std::memory_order_relaxed);
+	context.Resolve(rowStart, context.Width);
+}
+
+void ReferenceBackend::RenderPixel(const FrameContext& context, const PathTracer& pathTracer, uint32_t x, uint32_t y) const
+{
+	const uint32_t index = x + y * context.Width;
+	uint32_t rayCount = 0;
+	context.Accumulate(index, pathTracer.TracePixel(x, y, rayCount));
+	context.RayCount->fetch_add(rayCount, std::memory_order_relaxed);
+	context.Resolve(index, 1);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "RenderBackend.h"
+
+class PathTracer;
+
+// One complete path per pixel, pixel after pixel along every row.
+class ReferenceBackend : public RenderBackend
+{
+public:
+	static constexpr const char* Name = "Reference";
+
+	const char* GetName() const override { return Name; }
+	void RenderFrame(const FrameContext& context) override;
+
+private:
+	void RenderRow(const FrameContext& context, const PathTracer& pathTracer, uint32_t y) const;
+	void RenderPixel(const FrameContext& context, const PathTracer& pathTracer, uint32_t x, uint32_t y) const;
+
+private:
+	std::vector<uint32_t> _imageHorIter;
+};
@@ -0,0 +1,70 @@
+#include "ReferenceScene.h"
+
+std::vector<ReferenceScene> ReferenceScene::CreateAll()
+{
+	std::vector<ReferenceScene> scenes;
+
+	{
+		ReferenceScene& reference = scenes.emplace_back();
+		reference.Name = "default";
+		reference.ReferenceSceneData = Scene::CreateDefault();
+		reference.CameraPosition = {0.0f, 0.0f, 6.0f};
+	}
+
+	{
+		ReferenceScene& reference = scenes.emplace_back();
+		reference.Name = "grid";
+		Scene& scene = reference.ReferenceSceneData;
+
+		for (int i = 0; i < 4; i++)
+		{
+			Material& material = scene.Materials.emplace_back();
+			material.Albedo = {0.2f + 0.2f * i, 0.8f - 0.15f * i, 0.5f};
+			material.Roughness = 0.3f * i;
+			material.Metallic = i % 2 == 0 ? 1.0f : 0.0f;
+		}
+
+		for (int z = 0; z < 3; z++)
+		{
+			for (int x = 0; x < 3; x++)
+			{
+				Sphere sphere;
+				sphere.Radius = 0.4f;
+				sphere.Position = {(x - 1) * 1.1f, 0.0f, -z * 1.1f};
+				sphere.MaterialIndex = (x + z) % 4;
+				scene.Spheres.push_back(sphere);
+			}
+		}
+
+		Sphere ground;
+		ground.Radius = 100.0f;
+		ground.Position = {0.0f, -100.4f, 0.0f};
+		ground.MaterialIndex = 1;
+		scene.Spheres.push_back(ground);
+
+		reference.CameraPosition = {0.0f, 1.5f, 4.0f};
+		reference.CameraDirection = {0.0f, -0.35f, -1.0f};
+	}
+
+	{
+		// The camera starts inside a large sphere, every primary ray exits through its far side.
+		// The shell blocks the sun, so its glowing interior is what lights the spheres.
+		ReferenceScene& reference = scenes.emplace_back();
+		reference.Name = "inside";
+		reference.ReferenceSceneData = Scene::CreateDefault();
+
+		Material& glow = reference.ReferenceSceneData.Materials.emplace_back();
+		glow.Albedo = {0.8f, 0.8f, 0.8f};
+		glow.EmissionColor = {0.6f, 0.7f, 0.9f};
+		glow.EmissionPower = 0.8f;
+
+		Sphere shell;
+		shell.Radius = 20.0f;
+		shell.Position = {0.0f, 0.0f, 0.0f};
+		shell.MaterialIndex = static_cast<int>(reference.ReferenceSceneData.Materials.size() - 1);
+		reference.ReferenceSceneData.Spheres.push_back(shell);
+		reference.CameraPosition = {0.0f, 0.5f, 4.0f};
+	}
+
+	return scenes;
+}
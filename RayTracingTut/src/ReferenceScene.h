@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/vec3.hpp>
+
+#include "Scene.h"
+
+// Fixed scenes with their camera, shared by the regression checks and the benchmarks.
+struct ReferenceScene
+{
+	std::string Name;
+	Scene ReferenceSceneData;
+	glm::vec3 CameraPosition{0.0f};
+	glm::vec3 CameraDirection{0.0f, 0.0f, -1.0f};
+
+	static std::vector<ReferenceScene> CreateAll();
+};
@@ -0,0 +1,73 @@
+#include "RenderBackend.h"
+
+#include <span>
+
+#include "ReferenceBackend.h"
+#include "WavefrontBackend.h"
+
+namespace
+{
+	struct BackendEntry
+	{
+		std::string Name;
+		std::function<std::unique_ptr<RenderBackend>()> Create;
+	};
+
+	const std::vector<BackendEntry>& GetEntries()
+	{
+		static const std::vector<BackendEntry> entries = {
+			{ReferenceBackend::Name, [] { return std::make_unique<ReferenceBackend>(); }},
+			{WavefrontBackend::Name, [] { return std::make_unique<WavefrontBackend>(); }},
+		};
+
+		return entries;
+	}
+}
+
+void FrameContext::Accumulate(uint32_t index, const glm::vec4& color) const
+{
+	// The first frame overwrites instead of clearing the whole buffer up front, which keeps the pages on the rendering node.
+	if (FrameIndex == 1)
+	{
+		AccumulationData[index] = color;
+	}
+	else
+	{
+		AccumulationData[index] += color;
+	}
+}
+
+void FrameContext::Resolve(uint32_t index, uint32_t count) const
+{
+	Utils::ConvertToRGBA(std::span(AccumulationData + index, count), std::span(ImageData + index, count),
+		1.0f / static_cast<float>(FrameIndex), ToneMapping);
+}
+
+const std::vector<std::string>& RenderBackendRegistry::GetNames()
+{
+	static const std::vector<std::string> names = []
+	{
+		std::vector<std::string> result;
+		for (const BackendEntry& entry : GetEntries())
+		{
+			result.push_back(entry.Name);
+		}
+
+		return result;
+	}();
+
+	return names;
+}
+
+std::unique_ptr<RenderBackend> RenderBackendRegistry::Create(std::string_view name)
+{
+	for (const BackendEntry& entry : GetEntries())
+	{
+		if (entry.Name == name)
+		{
+			return entry.Create();
+		}
+	}
+
+	return nullptr;
+}
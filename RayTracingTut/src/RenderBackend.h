@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "Utils.h"
+
+struct Sphere;
+struct Material;
+struct SceneGeometry;
+struct CompactSpheres;
+class Camera;
+
+// Everything a backend needs for one frame. The Renderer owns the buffers, decides how rows are
+// spread over threads and uploads the image once the backend returns.
+struct FrameContext
+{
+	const std::vector<Sphere>* Spheres = nullptr;
+	const std::vector<Material>* Materials = nullptr;
+	// Scene bounds, null when rays can't be rejected up front.
+	const SceneGeometry* Geometry = nullptr;
+	// Null unless the spheres should be read from their packed copy.
+	const CompactSpheres* Compact = nullptr;
+	const Camera* FrameCamera = nullptr;
+
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	// 1 for the first accumulated sample.
+	uint32_t FrameIndex = 1;
+	uint32_t Seed = 0;
+	int Bounces = 2;
+	glm::vec3 LightDirection{-1.0f};
+	glm::vec3 BackColor{0.0f};
+	bool UseBsdfSampling = true;
+	bool UseRussianRoulette = true;
+	Utils::ToneMap ToneMapping = Utils::ToneMap::None;
+	// Rows already run in parallel, backends may spread the pixels of a row as well.
+	bool IsMultiThreadInner = false;
+
+	glm::vec4* AccumulationData = nullptr;
+	uint32_t* ImageData = nullptr;
+	std::atomic<uint64_t>* RayCount = nullptr;
+
+	// Runs rowFunc once for every row, serially, in parallel or on the NUMA workers.
+	std::function<void(const std::function<void(uint32_t)>&)> ForEachRow;
+
+	// Adds a sample to a pixel, the first frame overwrites whatever the buffer held.
+	void Accumulate(uint32_t index, const glm::vec4& color) const;
+	// Tone maps and packs the accumulated pixels [index, index + count) into the image.
+	void Resolve(uint32_t index, uint32_t count) const;
+};
+
+// A way of turning a frame into accumulated samples. Backends must render the same image,
+// they only differ in how they organize the work.
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() = default;
+
+	virtual const char* GetName() const = 0;
+	virtual void RenderFrame(const FrameContext& context) = 0;
+};
+
+class RenderBackendRegistry
+{
+public:
+	// The reference backend comes first and is the default.
+	static const std::vector<std::string>& GetNames();
+	static const std::string& GetDefaultName() { return GetNames().front(); }
+	// Null when no backend has that name.
+	static std::unique_ptr<RenderBackend> Create(std::string_view name);
+};
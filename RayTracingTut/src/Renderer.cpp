@@ -1,37 +1,58 @@
 #include "Renderer.h"
 
 #include <complex>
+#include <cstring>
 #include <dinput.h>
 #include <execution>
 #include <glm/gtc/epsilon.hpp>
 
 #include "Scene.h"
+#include "SceneSnapshot.h"
 #include "Camera.h"
 #include "Ray.h"
 #include "Utils.h"
-#include "Walnut/Random.h"
 
-Renderer::Renderer()
+Renderer::Renderer(bool isHeadless)
 	: Bounces(2),
 	LightDirection(-1.0f, -1.0f, -1.0f),
-	BackColor(0.2f, 0.2f, 0.2) {}
+	BackColor(0.2f, 0.2f, 0.2),
+	_isHeadless(isHeadless),
+	_backend(RenderBackendRegistry::Create(RenderBackendRegistry::GetDefaultName())) {}
+
+Renderer::~Renderer()
+{
+	delete[] _imageData;
+	delete[] _accumulationData;
+}
 
 void Renderer::OnResize(uint32_t width, uint32_t height)
 {
-	if (_finalImage)
+	if (_imageData && _width == width && _height == height)
 	{
-		if (_finalImage->GetWidth() == width && _finalImage->GetHeight() == height)
+		// Same size, but the buffers still have to move if the NUMA placement changed.
+		if (_isNumaPlaced == IsNumaAware)
 		{
 			return;
 		}
-
-		_finalImage->Resize(width, height);
 	}
-	else
+
+	_width = width;
+	_height = height;
+
+	// Headless renderers never touch the GPU, they only fill the CPU buffers.
+	if (!_isHeadless)
 	{
-		_finalImage = std::make_shared<Walnut::Image>(width, height, Walnut::ImageFormat::RGBA);
+		if (_finalImage)
+		{
+			_finalImage->Resize(width, height);
+		}
+		else
+		{
+			_finalImage = std::make_shared<Walnut::Image>(width, height, Walnut::ImageFormat::RGBA);
+		}
 	}
 
+	// new[] leaves the pixels untouched, the first write decides the page placement.
 	const uint32_t size = width * height;
 	delete[] _imageData;
 	_imageData = new uint32_t[size];
@@ -39,12 +60,19 @@ void Renderer::OnResize(uint32_t width, uint32_t height)
 	delete[] _accumulationData;
 	_accumulationData = new glm::vec4[size];
 
-	_imageHorIter.resize(width);
-	for (uint32_t i = 0; i < width; i++)
+	if (IsNumaAware)
 	{
-		_imageHorIter[i] = i;
+		// First touch every row from the node that will render it.
+		ForEachRow(height, [this, width](uint32_t y)
+		{
+			memset(_imageData + y * width, 0, width * sizeof(uint32_t));
+			memset(_accumulationData + y * width, 0, width * sizeof(glm::vec4));
+		});
 	}
 
+	_isNumaPlaced = IsNumaAware;
+	ResetFrameIndex();
+
 	_imageVertIter.resize(height);
 	for (uint32_t i = 0; i < height; i++)
 	{
@@ -54,70 +82,82 @@ void Renderer::OnResize(uint32_t width, uint32_t height)
 
 void Renderer::Render(const Scene& scene, const Camera& camera)
 {
-	_activeScene = &scene;
-	_activeCamera = &camera;
+	_activeSnapshot.reset();
+	_activeGeometry = nullptr;
+	_activeCompact = nullptr;
+	RenderFrame(scene.Spheres, scene.Materials, camera);
+}
+
+void Renderer::Render(std::shared_ptr<const SceneSnapshot> snapshot, const Camera& camera)
+{
+	// Holding the snapshot keeps it alive and unchanged for the whole frame, whatever the editor does.
+	_activeSnapshot = std::move(snapshot);
+	_activeGeometry = _activeSnapshot->Geometry.get();
+	_activeCompact = IsCompactGeometry ? _activeSnapshot->Compact.get() : nullptr;
+	RenderFrame(*_activeSnapshot->Spheres, *_activeSnapshot->Materials, camera);
+}
 
-	if (_frameIndex == 1)
+bool Renderer::SetBackend(std::string_view name)
+{
+	if (name == _backend->GetName())
 	{
-		memset(_accumulationData, 0, _finalImage->GetWidth() * _finalImage->GetHeight() * sizeof(glm::vec4));
+		return true;
 	}
 
-	if (IsMultiThread)
+	std::unique_ptr<RenderBackend> backend = RenderBackendRegistry::Create(name);
+	if (!backend)
 	{
-		std::for_each(std::execution::par, _imageVertIter.begin(), _imageVertIter.end(),
-			[this](uint32_t y)
-			{
-				if (IsMultiThreadInner)
-				{
-					std::for_each(std::execution::par, _imageHorIter.begin(), _imageHorIter.end(),
-						[this,y](uint32_t x)
-						{
-							const auto color = PerPixel(x, y);
-							_accumulationData[x + y * _finalImage->GetWidth()] += color;
+		return false;
+	}
 
-							glm::vec4 accumulatedColor = _accumulationData[x + y * _finalImage->GetWidth()];
-							accumulatedColor /= static_cast<float>(_frameIndex);
+	_backend = std::move(backend);
+	ResetFrameIndex();
+	return true;
+}
 
-							accumulatedColor = glm::clamp(accumulatedColor, glm::vec4(0.0f), glm::vec4(1.0f));
-							_imageData[x + y * _finalImage->GetWidth()] = Utils::ConvertToRGBA(accumulatedColor);
-						});
-				}
-				else
-				{
-					for (uint32_t x = 0; x < _finalImage->GetWidth(); x++)
-					{
-						const auto color = PerPixel(x, y);
-						_accumulationData[x + y * _finalImage->GetWidth()] += color;
+void Renderer::RenderFrame(const std::vector<Sphere>& spheres, const std::vector<Material>& materials, const Camera& camera)
+{
+	_rayCount = 0;
+
+	FrameContext context;
+	context.Spheres = &spheres;
+	context.Materials = &materials;
+	context.Geometry = _activeGeometry;
+	context.Compact = _activeCompact;
+	context.FrameCamera = &camera;
+	context.Width = _width;
+	context.Height = _height;
+	context.FrameIndex = _frameIndex;
+	context.Seed = _settings.Seed;
+	context.Bounces = Bounces;
+	context.LightDirection = LightDirection;
+	context.BackColor = BackColor;
+	context.UseBsdfSampling = _settings.UseBsdfSampling;
+	context.UseRussianRoulette = _settings.UseRussianRoulette;
+	context.ToneMapping = _settings.ToneMapping;
+	context.IsMultiThreadInner = IsMultiThread && IsMultiThreadInner && !IsNumaAware;
+	context.AccumulationData = _accumulationData;
+	context.ImageData = _imageData;
+	context.RayCount = &_rayCount;
+	context.ForEachRow = [this](const std::function<void(uint32_t)>& rowFunc)
+	{
+		ScheduleRows(rowFunc);
+	};
 
-						glm::vec4 accumulatedColor = _accumulationData[x + y * _finalImage->GetWidth()];
-						accumulatedColor /= static_cast<float>(_frameIndex);
+	_backend->RenderFrame(context);
 
-						accumulatedColor = glm::clamp(accumulatedColor, glm::vec4(0.0f), glm::vec4(1.0f));
-						_imageData[x + y * _finalImage->GetWidth()] = Utils::ConvertToRGBA(accumulatedColor);
-					}
-				}
-			});
-	}
-	else
+	if (IsNumaAware)
 	{
-		// render every pixel
-		for (uint32_t y = 0; y < _finalImage->GetHeight(); y++)
-		{
-			for (uint32_t x = 0; x < _finalImage->GetWidth(); x++)
-			{
-				const auto color = PerPixel(x, y);
-				_accumulationData[x + y * _finalImage->GetWidth()] += color;
-
-				glm::vec4 accumulatedColor = _accumulationData[x + y * _finalImage->GetWidth()];
-				accumulatedColor /= static_cast<float>(_frameIndex);
+		_nodeStats = _workerPool->GetNodeStats();
+	}
 
-				accumulatedColor = glm::clamp(accumulatedColor, glm::vec4(0.0f), glm::vec4(1.0f));
-				_imageData[x + y * _finalImage->GetWidth()] = Utils::ConvertToRGBA(accumulatedColor);
-			}
-		}
+	if (_finalImage)
+	{
+		_finalImage->SetData(_imageData);
 	}
 
-	_finalImage->SetData(_imageData);
+	_accumulatedSamples = _frameIndex;
+	_lastRayCount = _rayCount;
 	if (_settings.ShouldAccumulate)
 	{
 		_frameIndex++;
@@ -128,134 +168,42 @@ void Renderer::Render(const Scene& scene, const Camera& camera)
 	}
 }
 
-glm::vec4 Renderer::PerPixel(uint32_t x, uint32_t y) const
+void Renderer::ScheduleRows(const std::function<void(uint32_t)>& rowFunc)
 {
-	Ray ray;
-	ray.Origin = _activeCamera->GetPosition();
-	ray.Direction = _activeCamera->GetRayDirections()[x + y * _finalImage->GetWidth()];
-
-	glm::vec3 color(0.0f);
-	float multiplier = 1.0f;
-
-	for (int i = 0; i < Bounces; ++i)
+	if (IsNumaAware)
 	{
-		HitPayload payload = TraceRay(ray);
-		if (payload.HitDistance < 0.0f)
-		{
-			glm::vec3 skyColor = BackColor;
-			color += skyColor * multiplier;
-			break;
-		}
-
-		const glm::vec3 lightDir = glm::normalize(LightDirection);
-		float lightIntensity = glm::max(0.0f, glm::dot(payload.WorldNormal, -lightDir));
-
-		const Sphere& sphere = _activeScene->Spheres[payload.ObjectIndex];
-		if (sphere.MaterialIndex > _activeScene->Materials.size() - 1)
-		{
-			break;
-		}
-
-		const Material& material = _activeScene->Materials[sphere.MaterialIndex];
-
-		auto sphereColor = material.Albedo;
-		sphereColor *= lightIntensity;
-
-		color += sphereColor * multiplier;
-		multiplier *= 0.5f;
-
-		ray.Origin = payload.WorldPosition + payload.WorldNormal * 0.0001f;
-		ray.Direction = glm::reflect(ray.Direction,
-			payload.WorldNormal + material.Roughness * Walnut::Random::Vec3(-0.5f, 0.5f));
+		ForEachRow(_height, rowFunc);
 	}
-
-	return glm::vec4(color, 1.0f);
-}
-
-Renderer::HitPayload Renderer::TraceRay(const Ray& ray) const
-{
-	int closestSphere = -1;
-	float closestHit = std::numeric_limits<float>::max();
-	for (size_t i = 0; i < _activeScene->Spheres.size(); i++)
+	else if (IsMultiThread)
 	{
-		const auto& sphere = _activeScene->Spheres[i];
-		if (IntersectSphere(ray, sphere, closestHit))
-		{
-			closestSphere = static_cast<int>(i);
-		}
+		std::for_each(std::execution::par, _imageVertIter.begin(), _imageVertIter.end(), rowFunc);
 	}
-
-	if (closestSphere < 0)
+	else
 	{
-		return Miss(ray);
+		// render every row
+		for (uint32_t y = 0; y < _height; y++)
+		{
+			rowFunc(y);
+		}
 	}
-
-	return ClosestHit(ray, closestHit, closestSphere);
-
-	//return DrawSphere(ray, *closestSphere, closestHit);
-}
-
-Renderer::HitPayload Renderer::ClosestHit(const Ray& ray, float hitDistance, int objectIndex) const
-{
-	HitPayload payload;
-	payload.HitDistance = hitDistance;
-	payload.ObjectIndex = objectIndex;
-
-	const Sphere& closestSphere = _activeScene->Spheres[objectIndex];
-
-	const glm::vec3 rayOrigin = ray.Origin - closestSphere.Position;
-
-	payload.WorldPosition = rayOrigin + ray.Direction * hitDistance;
-	payload.WorldNormal = glm::normalize(payload.WorldPosition);
-	payload.WorldPosition += closestSphere.Position;
-
-	return payload;
 }
 
-Renderer::HitPayload Renderer::Miss(const Ray& ray) const
+void Renderer::ForEachRow(uint32_t height, const std::function<void(uint32_t)>& rowFunc)
 {
-	HitPayload payload{};
-	payload.HitDistance = -1.0f;
-	return payload;
-}
-
-bool Renderer::IntersectSphere(const Ray& ray, const Sphere& sphere, float& closestHit) const
-{
-	const glm::vec3 rayOrigin = ray.Origin - sphere.Position;
-	const float a = glm::dot(ray.Direction, ray.Direction);
-	const float b = 2.0f * glm::dot(rayOrigin, ray.Direction);
-	const float c = glm::dot(rayOrigin, rayOrigin) - sphere.Radius * sphere.Radius;
-
-	const float discriminant = b * b - 4.0f * a * c;
-
-	if (discriminant < 0.0f)
+	if (!IsNumaAware)
 	{
-		return false;
-	}
-
-	// Get the closest point on the sphere from the camera
-	float closestT = (-b - glm::sqrt(discriminant)) / (2.0f * a);
-	// Get the point the second intersection point after closest point.
-	float t0 = (-b + glm::sqrt(discriminant)) / (2.0f * a);
-
-	// If the closest point is negative it means it is behind the camera.
-	if (closestT < 0.0f)
-	{
-		// If the second point is also negative it means it is also behind the camera.
-		if (t0 < 0.0f)
+		for (uint32_t y = 0; y < height; y++)
 		{
-			return false;
+			rowFunc(y);
 		}
 
-		// Else it means we are inside the sphere so we will use the second point.
-		closestT = t0;
+		return;
 	}
 
-	if (closestT < closestHit)
+	if (!_workerPool)
 	{
-		closestHit = closestT;
-		return true;
+		_workerPool = std::make_unique<NumaWorkerPool>();
 	}
 
-	return false;
+	_workerPool->ForEachRow(height, rowFunc);
 }
@@ -2,72 +2,118 @@
 
 
 #include "Walnut/Image.h"
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <string_view>
 #include <vector>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
+#include "NumaWorkerPool.h"
+#include "RenderBackend.h"
+#include "Utils.h"
+
 struct Scene;
+struct CompactSpheres;
 struct Sphere;
-struct Ray;
+struct Material;
+struct SceneGeometry;
+struct SceneSnapshot;
 class Camera;
 
+// Owns the framebuffer, the accumulation and the image upload, and spreads rows over threads.
+// Tracing itself is done by the selected RenderBackend.
 class Renderer
 {
 public:
 	struct Settings
 	{
 		bool ShouldAccumulate = true;
+		// Mixed into every pixel's random sequence, a fixed seed renders the same image every run.
+		uint32_t Seed = 0;
+		Utils::ToneMap ToneMapping = Utils::ToneMap::None;
+		// Importance sample the material BSDF and light the hits directly, off keeps the original reflect-and-halve shading.
+		bool UseBsdfSampling = true;
+		// Randomly end dim paths after a couple of bounces and reweight the survivors. Only used with BSDF sampling.
+		bool UseRussianRoulette = true;
 	};
 
 public:
-	Renderer();
+	explicit Renderer(bool isHeadless = false);
+	~Renderer();
+
+	Renderer(const Renderer&) = delete;
+	Renderer& operator=(const Renderer&) = delete;
 
 	void OnResize(uint32_t width, uint32_t height);
 	void Render(const Scene& scene, const Camera& camera);
+	// Renders an editor snapshot, using its geometry to skip rays that miss the whole scene.
+	void Render(std::shared_ptr<const SceneSnapshot> snapshot, const Camera& camera);
 	std::shared_ptr<Walnut::Image> GetFinalImage() const { return _finalImage; }
+	uint32_t GetWidth() const { return _width; }
+	uint32_t GetHeight() const { return _height; }
+	// Packed RGBA of the last rendered frame, bottom row first.
+	const uint32_t* GetImageData() const { return _imageData; }
+	// Sum of GetAccumulatedSampleCount() samples per pixel, bottom row first.
+	const glm::vec4* GetAccumulationData() const { return _accumulationData; }
+	uint32_t GetAccumulatedSampleCount() const { return _accumulatedSamples; }
+	// Camera, bounce and shadow rays traced by the last frame.
+	uint64_t GetRayCount() const { return _lastRayCount; }
 
 	void ResetFrameIndex() { _frameIndex = 1; }
 	Settings& GetSettings() { return _settings; }
 
+	// Switches to a backend of RenderBackendRegistry, false if there is none with that name.
+	bool SetBackend(std::string_view name);
+	const char* GetBackendName() const { return _backend->GetName(); }
+
+	// Runs rowFunc for every row on the same workers that render that row.
+	void ForEachRow(uint32_t height, const std::function<void(uint32_t)>& rowFunc);
+	const std::vector<NumaWorkerPool::NodeStats>& GetNodeStats() const { return _nodeStats; }
+	// Null until the first NUMA aware frame.
+	const NumaWorkerPool* GetWorkerPool() const { return _workerPool.get(); }
+
 public:
 	int Bounces;
 	glm::vec3 LightDirection;
 	glm::vec3 BackColor;
 	bool IsMultiThread = false;
 	bool IsMultiThreadInner = false;
+	bool IsNumaAware = false;
+	// Intersect against the snapshot's CompactSpheres instead of its spheres, renders the same image.
+	// The packed copy is built once per committed snapshot, Render(scene) always reads the Scene spheres.
+	bool IsCompactGeometry = false;
 
 private:
 	Settings _settings;
 	std::shared_ptr<Walnut::Image> _finalImage;
+	bool _isHeadless = false;
+	uint32_t _width = 0;
+	uint32_t _height = 0;
 
-	std::vector<uint32_t> _imageHorIter;
 	std::vector<uint32_t> _imageVertIter;
 
 	uint32_t* _imageData = nullptr;
 	glm::vec4* _accumulationData = nullptr;
 
 	uint32_t _frameIndex = 1;
+	uint32_t _accumulatedSamples = 0;
 
-	const Scene* _activeScene = nullptr;
-	const Camera* _activeCamera = nullptr;
-
-private:
-	struct HitPayload
-	{
-		float HitDistance;
-		glm::vec3 WorldPosition;
-		glm::vec3 WorldNormal;
+	std::atomic<uint64_t> _rayCount = 0;
+	uint64_t _lastRayCount = 0;
 
-		int ObjectIndex;
-	};
+	std::unique_ptr<RenderBackend> _backend;
+	const SceneGeometry* _activeGeometry = nullptr;
+	const CompactSpheres* _activeCompact = nullptr;
+	std::shared_ptr<const SceneSnapshot> _activeSnapshot;
 
-	glm::vec4 PerPixel(uint32_t x, uint32_t y) const;
+	std::unique_ptr<NumaWorkerPool> _workerPool;
+	std::vector<NumaWorkerPool::NodeStats> _nodeStats;
+	bool _isNumaPlaced = false;
 
-	HitPayload TraceRay(const Ray& ray) const;
-	HitPayload ClosestHit(const Ray& ray, float hitDistance, int objectIndex) const;
-	HitPayload Miss(const Ray& ray) const;
-
-	bool IntersectSphere(const Ray& ray, const Sphere& sphere, float& closestHit) const;
+private:
+	void RenderFrame(const std::vector<Sphere>& spheres, const std::vector<Material>& materials, const Camera& camera);
+	void ScheduleRows(const std::function<void(uint32_t)>& rowFunc);
 };
@@ -0,0 +1,32 @@
+#include "Scene.h"
+
+Scene Scene::CreateDefault()
+{
+	Scene scene;
+
+	{
+		Material& material = scene.Materials.emplace_back();
+		material.Albedo = {1.0f, 0.4f, 1.0f};
+		material.Roughness = 0.0f;
+
+		Sphere sphere;
+		sphere.Radius = 1.0f;
+		sphere.Position = {0.0f, 0.0f, 0.0f};
+		sphere.MaterialIndex = 0;
+		scene.Spheres.push_back(sphere);
+	}
+
+	{
+		Material& material = scene.Materials.emplace_back();
+		material.Albedo = {0.2f, 0.9f, 1.0f};
+		material.Roughness = 0.02f;
+
+		Sphere sphere;
+		sphere.Radius = 100.0f;
+		sphere.Position = {0.0f, -101.0f, 0.0f};
+		sphere.MaterialIndex = 1;
+		scene.Spheres.push_back(sphere);
+	}
+
+	return scene;
+}
@@ -10,6 +10,10 @@ struct Material
 	glm::vec3 Albedo{1.0f};
 	float Roughness = 1.0f;
 	float Metallic = 0.0f;
+	glm::vec3 EmissionColor{0.0f};
+	float EmissionPower = 0.0f;
+
+	glm::vec3 GetEmission() const { return EmissionColor * EmissionPower; }
 };
 
 struct Sphere
@@ -23,4 +27,6 @@ struct Scene
 {
 	std::vector<Sphere> Spheres;
 	std::vector<Material> Materials;
+
+	static Scene CreateDefault();
 };
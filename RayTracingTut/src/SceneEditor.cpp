@@ -0,0 +1,171 @@
+#include "SceneEditor.h"
+
+#include <algorithm>
+
+SceneEditor::SceneEditor(Scene scene)
+	: _scene(std::move(scene))
+{
+	auto geometry = std::make_shared<SceneGeometry>();
+	geometry->Build(_scene.Spheres);
+
+	auto compact = std::make_shared<CompactSpheres>();
+	compact->Build(_scene);
+
+	auto snapshot = std::make_shared<SceneSnapshot>();
+	snapshot->Spheres = std::make_shared<const std::vector<Sphere>>(_scene.Spheres);
+	snapshot->Materials = std::make_shared<const std::vector<Material>>(_scene.Materials);
+	snapshot->Geometry = std::move(geometry);
+	snapshot->Compact = std::move(compact);
+	_snapshot = std::move(snapshot);
+
+	_sphereDirtyFlags.assign(_scene.Spheres.size(), SphereClean);
+	_materialDirtyFlags.assign(_scene.Materials.size(), 0);
+}
+
+void SceneEditor::SetSphere(size_t index, const Sphere& sphere)
+{
+	Sphere& current = _scene.Spheres[index];
+	if (sphere.Position != current.Position || sphere.Radius != current.Radius)
+	{
+		_sphereDirtyFlags[index] |= SphereGeometryDirty;
+	}
+
+	if (sphere.MaterialIndex != current.MaterialIndex)
+	{
+		_sphereDirtyFlags[index] |= SphereMaterialDirty;
+	}
+
+	current = sphere;
+}
+
+void SceneEditor::SetMaterial(size_t index, const Material& material)
+{
+	Material& current = _scene.Materials[index];
+	if (material.Albedo != current.Albedo || material.Roughness != current.Roughness || material.Metallic != current.Metallic
+		|| material.EmissionColor != current.EmissionColor || material.EmissionPower != current.EmissionPower)
+	{
+		_materialDirtyFlags[index] = 1;
+		current = material;
+	}
+}
+
+void SceneEditor::AddSphere(const Sphere& sphere)
+{
+	_scene.Spheres.push_back(sphere);
+	_sphereDirtyFlags.push_back(SphereClean);
+	_isStructureDirty = true;
+}
+
+void SceneEditor::ClearSpheres()
+{
+	if (_scene.Spheres.empty())
+	{
+		return;
+	}
+
+	_scene.Spheres.clear();
+	_sphereDirtyFlags.clear();
+	_isStructureDirty = true;
+}
+
+SceneEditor::Changes SceneEditor::Commit()
+{
+	Changes changes;
+	changes.IsStructural = _isStructureDirty;
+	for (uint32_t i = 0; i < _sphereDirtyFlags.size(); i++)
+	{
+		if (_sphereDirtyFlags[i] & SphereGeometryDirty)
+		{
+			changes.MovedSpheres.push_back(i);
+		}
+
+		if (_sphereDirtyFlags[i] & SphereMaterialDirty)
+		{
+			changes.RematerializedSpheres.push_back(i);
+		}
+	}
+
+	for (uint32_t i = 0; i < _materialDirtyFlags.size(); i++)
+	{
+		if (_materialDirtyFlags[i])
+		{
+			changes.EditedMaterials.push_back(i);
+		}
+	}
+
+	if (!changes.IsStructural && changes.MovedSpheres.empty() && changes.RematerializedSpheres.empty() && changes.EditedMaterials.empty())
+	{
+		return changes;
+	}
+
+	changes.AffectsImage = changes.HasGeometryChanged() || !changes.RematerializedSpheres.empty();
+	for (const uint32_t materialIndex : changes.EditedMaterials)
+	{
+		changes.AffectsImage = changes.AffectsImage || IsMaterialUsed(materialIndex);
+	}
+
+	auto snapshot = std::make_shared<SceneSnapshot>();
+	snapshot->Version = _snapshot->Version + 1;
+
+	// Copy only the arrays that were edited, a slider dragged every frame must not copy the whole scene.
+	const bool areSpheresDirty = changes.IsStructural || !changes.MovedSpheres.empty() || !changes.RematerializedSpheres.empty();
+	snapshot->Spheres = areSpheresDirty ? std::make_shared<const std::vector<Sphere>>(_scene.Spheres) : _snapshot->Spheres;
+	snapshot->Materials = !changes.EditedMaterials.empty()
+		? std::make_shared<const std::vector<Material>>(_scene.Materials)
+		: _snapshot->Materials;
+
+	if (changes.IsStructural)
+	{
+		auto geometry = std::make_shared<SceneGeometry>();
+		geometry->Build(_scene.Spheres);
+		snapshot->Geometry = std::move(geometry);
+	}
+	else if (!changes.MovedSpheres.empty())
+	{
+		// The previous snapshot may still be rendering, refit a copy. It is only the scene box, copying it is free.
+		auto geometry = std::make_shared<SceneGeometry>(*_snapshot->Geometry);
+		geometry->Refit(_scene.Spheres, *_snapshot->Spheres, changes.MovedSpheres);
+		snapshot->Geometry = std::move(geometry);
+	}
+	else
+	{
+		snapshot->Geometry = _snapshot->Geometry;
+	}
+
+	if (changes.IsStructural)
+	{
+		auto compact = std::make_shared<CompactSpheres>();
+		compact->Build(_scene);
+		snapshot->Compact = std::move(compact);
+	}
+	else if (!changes.MovedSpheres.empty() || !changes.RematerializedSpheres.empty())
+	{
+		auto compact = std::make_shared<CompactSpheres>(*_snapshot->Compact);
+		compact->Update(_scene, changes.MovedSpheres);
+		compact->Update(_scene, changes.RematerializedSpheres);
+		snapshot->Compact = std::move(compact);
+	}
+	else
+	{
+		snapshot->Compact = _snapshot->Compact;
+	}
+
+	_snapshot = std::move(snapshot);
+	std::fill(_sphereDirtyFlags.begin(), _sphereDirtyFlags.end(), SphereClean);
+	std::fill(_materialDirtyFlags.begin(), _materialDirtyFlags.end(), 0);
+	_isStructureDirty = false;
+	return changes;
+}
+
+bool SceneEditor::IsMaterialUsed(uint32_t materialIndex) const
+{
+	for (const Sphere& sphere : _scene.Spheres)
+	{
+		if (sphere.MaterialIndex == static_cast<int>(materialIndex))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Scene.h"
+#include "SceneSnapshot.h"
+
+// Owns the editable scene, tracks what each edit touched and publishes immutable snapshots.
+class SceneEditor
+{
+public:
+	struct Changes
+	{
+		// Spheres were added or removed, the geometry was rebuilt.
+		bool IsStructural = false;
+		std::vector<uint32_t> MovedSpheres;
+		std::vector<uint32_t> RematerializedSpheres;
+		std::vector<uint32_t> EditedMaterials;
+		// False when every edit is invisible, e.g. a material no sphere uses.
+		bool AffectsImage = false;
+
+		bool HasGeometryChanged() const { return IsStructural || !MovedSpheres.empty(); }
+	};
+
+public:
+	explicit SceneEditor(Scene scene);
+
+	// The working copy, edits are only visible to the renderer after Commit.
+	const Scene& GetScene() const { return _scene; }
+	const std::shared_ptr<const SceneSnapshot>& GetSnapshot() const { return _snapshot; }
+	uint64_t GetVersion() const { return _snapshot->Version; }
+
+	// Edits equal to the current value are ignored.
+	void SetSphere(size_t index, const Sphere& sphere);
+	void SetMaterial(size_t index, const Material& material);
+	void AddSphere(const Sphere& sphere);
+	void ClearSpheres();
+
+	// Publishes pending edits as a new snapshot and reports what changed since the previous one.
+	// Only the edited sphere or material array is copied, the other one and untouched geometry are shared.
+	// Moved spheres refit the previous geometry.
+	Changes Commit();
+
+private:
+	enum SphereDirtyFlags : uint8_t
+	{
+		SphereClean = 0,
+		SphereGeometryDirty = 1 << 0,
+		SphereMaterialDirty = 1 << 1,
+	};
+
+	bool IsMaterialUsed(uint32_t materialIndex) const;
+
+private:
+	Scene _scene;
+	std::shared_ptr<const SceneSnapshot> _snapshot;
+
+	std::vector<uint8_t> _sphereDirtyFlags;
+	std::vector<uint8_t> _materialDirtyFlags;
+	bool _isStructureDirty = false;
+};
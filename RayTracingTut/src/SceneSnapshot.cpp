@@ -0,0 +1,71 @@
+#include "SceneSnapshot.h"
+
+#include <limits>
+#include <glm/glm.hpp>
+
+#include "Ray.h"
+
+void SceneGeometry::Build(const std::vector<Sphere>& spheres)
+{
+	SceneMin = glm::vec3(std::numeric_limits<float>::max());
+	SceneMax = glm::vec3(std::numeric_limits<float>::lowest());
+	IsEmpty = spheres.empty();
+	for (const Sphere& sphere : spheres)
+	{
+		Grow(sphere);
+	}
+}
+
+void SceneGeometry::Refit(const std::vector<Sphere>& spheres, const std::vector<Sphere>& previousSpheres,
+	std::span<const uint32_t> sphereIndices)
+{
+	// A sphere that defined a face may take the face with it when it moves, then only a rescan finds the new box.
+	for (const uint32_t index : sphereIndices)
+	{
+		if (TouchesFace(previousSpheres[index]))
+		{
+			Build(spheres);
+			return;
+		}
+	}
+
+	for (const uint32_t index : sphereIndices)
+	{
+		Grow(spheres[index]);
+	}
+}
+
+bool SceneGeometry::IntersectsScene(const Ray& ray) const
+{
+	if (IsEmpty)
+	{
+		return false;
+	}
+
+	// Slab test, the ray starts at t = 0.
+	const glm::vec3 inverseDirection = 1.0f / ray.Direction;
+	const glm::vec3 t0 = (SceneMin - ray.Origin) * inverseDirection;
+	const glm::vec3 t1 = (SceneMax - ray.Origin) * inverseDirection;
+	const glm::vec3 tMin = glm::min(t0, t1);
+	const glm::vec3 tMax = glm::max(t0, t1);
+
+	const float enter = glm::max(glm::max(tMin.x, tMin.y), glm::max(tMin.z, 0.0f));
+	const float exit = glm::min(glm::min(tMax.x, tMax.y), tMax.z);
+	return enter <= exit;
+}
+
+bool SceneGeometry::TouchesFace(const Sphere& sphere) const
+{
+	const glm::vec3 extent(glm::abs(sphere.Radius));
+	const glm::vec3 boundsMin = sphere.Position - extent;
+	const glm::vec3 boundsMax = sphere.Position + extent;
+	return boundsMin.x <= SceneMin.x || boundsMin.y <= SceneMin.y || boundsMin.z <= SceneMin.z
+		|| boundsMax.x >= SceneMax.x || boundsMax.y >= SceneMax.y || boundsMax.z >= SceneMax.z;
+}
+
+void SceneGeometry::Grow(const Sphere& sphere)
+{
+	const glm::vec3 extent(glm::abs(sphere.Radius));
+	SceneMin = glm::min(SceneMin, sphere.Position - extent);
+	SceneMax = glm::max(SceneMax, sphere.Position + extent);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include <glm/vec3.hpp>
+
+#include "CompactSpheres.h"
+#include "Scene.h"
+
+struct Ray;
+
+// One axis aligned box around all spheres, rays that miss it skip the intersection loop.
+// There is no hierarchy below it, the box alone is what the renderer tests.
+struct SceneGeometry
+{
+	glm::vec3 SceneMin{0.0f};
+	glm::vec3 SceneMax{0.0f};
+	bool IsEmpty = true;
+
+	void Build(const std::vector<Sphere>& spheres);
+	// Updates the box for the moved spheres, previousSpheres holds their positions before the move.
+	// Grows the box when every moved sphere was strictly inside it, only a move that may shrink it rescans all spheres.
+	void Refit(const std::vector<Sphere>& spheres, const std::vector<Sphere>& previousSpheres, std::span<const uint32_t> sphereIndices);
+
+	// False when the ray cannot hit any sphere, lets misses skip the intersection loop.
+	bool IntersectsScene(const Ray& ray) const;
+
+private:
+	bool TouchesFace(const Sphere& sphere) const;
+	void Grow(const Sphere& sphere);
+};
+
+// Immutable state handed to the renderer, edits publish a new snapshot instead of changing this one.
+// Unchanged parts are shared with the previous snapshot, a material edit copies only the materials.
+struct SceneSnapshot
+{
+	uint64_t Version = 0;
+	std::shared_ptr<const std::vector<Sphere>> Spheres;
+	std::shared_ptr<const std::vector<Material>> Materials;
+	std::shared_ptr<const SceneGeometry> Geometry;
+	std::shared_ptr<const CompactSpheres> Compact;
+};
@@ -0,0 +1,117 @@
+#include "SequenceRenderer.h"
+
+#include <format>
+#include <future>
+#include <optional>
+
+#include "SceneEditor.h"
+#include "Walnut/Timer.h"
+
+SequenceRenderer::SequenceRenderer(const Scene& scene, const CameraPath& cameraPath, const Settings& settings)
+	: _scene(scene),
+	_cameraPath(cameraPath),
+	_settings(settings) {}
+
+SequenceRenderer::Stats SequenceRenderer::Run()
+{
+	Stats stats;
+	if (_settings.FrameCount == 0 || _settings.Width == 0 || _settings.Height == 0 || !IsValidOutputPattern(_settings.OutputPattern))
+	{
+		return stats;
+	}
+
+	Walnut::Timer timer;
+	_framesRendered = 0;
+	_renderer.GetSettings().ShouldAccumulate = true;
+	_renderer.OnResize(_settings.Width, _settings.Height);
+
+	// Only the camera moves, the bounds and the packed spheres are built once for the whole sequence.
+	const std::shared_ptr<const SceneSnapshot> snapshot = SceneEditor(_scene).GetSnapshot();
+	Camera currentCamera = PrepareCamera(0);
+	for (uint32_t frame = 0; frame < _settings.FrameCount && !_isCancelled; frame++)
+	{
+		// Overlap the next frame's ray generation with this frame's tracing.
+		std::optional<std::future<Camera>> next;
+		if (frame + 1 < _settings.FrameCount)
+		{
+			next = std::async(std::launch::async, &SequenceRenderer::PrepareCamera, this, frame + 1);
+		}
+
+		_renderer.ResetFrameIndex();
+		for (uint32_t sample = 0; sample < _settings.SamplesPerFrame && !_isCancelled; sample++)
+		{
+			_renderer.Render(snapshot, currentCamera);
+		}
+
+		if (!_isCancelled)
+		{
+			WriteFrame(frame);
+			_framesRendered++;
+		}
+
+		if (next)
+		{
+			currentCamera = next->get();
+		}
+	}
+
+	_imageWriter.Flush();
+
+	stats.FramesRendered = _framesRendered;
+	stats.Seconds = timer.Elapsed();
+	stats.FramesPerHour = stats.Seconds > 0.0f ? static_cast<float>(stats.FramesRendered) * 3600.0f / stats.Seconds : 0.0f;
+	return stats;
+}
+
+bool SequenceRenderer::IsValidOutputPattern(std::string_view pattern)
+{
+	try
+	{
+		uint32_t frame = 0;
+		const std::string first = std::vformat(pattern, std::make_format_args(frame));
+		frame = 1;
+		const std::string second = std::vformat(pattern, std::make_format_args(frame));
+		return first != second && ImageWriter::IsSupportedPath(first);
+	}
+	catch (const std::format_error&)
+	{
+		return false;
+	}
+}
+
+void SequenceRenderer::WriteFrame(uint32_t frame)
+{
+	// Only the copy happens here, tone mapping, encoding and writing run on the ImageWriter thread.
+	const glm::vec4* accumulationData = _renderer.GetAccumulationData();
+	const size_t pixelCount = static_cast<size_t>(_settings.Width) * _settings.Height;
+	_imageWriter.EnqueueHdr(std::vformat(_settings.OutputPattern, std::make_format_args(frame)), _settings.Width, _settings.Height,
+		std::vector<glm::vec4>(accumulationData, accumulationData + pixelCount),
+		1.0f / static_cast<float>(_renderer.GetAccumulatedSampleCount()), _renderer.GetSettings().ToneMapping);
+}
+
+Camera SequenceRenderer::PrepareCamera(uint32_t frame)
+{
+	// Rows are computed by the workers that trace them, the pool runs them between this frame's samples.
+	Camera camera(_settings.VerticalFOV, 0.1f, 100.0f);
+	camera.SetRowExecutor([this](uint32_t height, const std::function<void(uint32_t)>& rowFunc)
+	{
+		_renderer.ForEachRow(height, rowFunc);
+	});
+
+	// Place the camera before sizing it, the empty viewport skips the rays so OnResize computes them once.
+	const CameraPath::Keyframe keyframe = _cameraPath.Evaluate(GetFrameTime(frame));
+	camera.SetView(keyframe.Position, keyframe.Direction);
+	camera.OnResize(_settings.Width, _settings.Height);
+	return camera;
+}
+
+float SequenceRenderer::GetFrameTime(uint32_t frame) const
+{
+	if (_settings.FrameCount <= 1)
+	{
+		return _cameraPath.GetStartTime();
+	}
+
+	const float t = static_cast<float>(frame) / static_cast<float>(_settings.FrameCount - 1);
+	return _cameraPath.GetStartTime() + (_cameraPath.GetEndTime() - _cameraPath.GetStartTime()) * t;
+}
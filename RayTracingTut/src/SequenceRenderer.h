@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <string_view>
+
+#include "Camera.h"
+#include "CameraPath.h"
+#include "ImageWriter.h"
+#include "Renderer.h"
+#include "Scene.h"
+
+// Renders a camera path to numbered files.
+// The scene snapshot is built once, while a frame is traced the next frame's camera rays are prepared
+// on another thread, and the previous frame is written by the background ImageWriter.
+class SequenceRenderer
+{
+public:
+	struct Settings
+	{
+		uint32_t Width = 1280;
+		uint32_t Height = 720;
+		uint32_t FrameCount = 60;
+		uint32_t SamplesPerFrame = 16;
+		float VerticalFOV = 45.0f;
+		// std::format pattern receiving the frame number, .pfm writes the float accumulation buffer.
+		std::string OutputPattern = "frames/frame_{:04}.png";
+	};
+
+	struct Stats
+	{
+		uint32_t FramesRendered = 0;
+		float Seconds = 0.0f;
+		float FramesPerHour = 0.0f;
+	};
+
+public:
+	SequenceRenderer(const Scene& scene, const CameraPath& cameraPath, const Settings& settings);
+
+	// Configure bounces, lighting and threading before calling Run.
+	Renderer& GetRenderer() { return _renderer; }
+
+	// Blocks until every frame is rendered and written, or Cancel was called.
+	// Renders nothing when the output pattern is invalid.
+	Stats Run();
+	void Cancel() { _isCancelled = true; }
+
+	uint32_t GetFramesRendered() const { return _framesRendered; }
+	uint32_t GetFrameCount() const { return _settings.FrameCount; }
+	uint32_t GetFailedWrites() const { return _imageWriter.GetFailedCount(); }
+
+	// A pattern has to format without errors, give different frames different names and use a format ImageWriter knows.
+	static bool IsValidOutputPattern(std::string_view pattern);
+
+private:
+	void WriteFrame(uint32_t frame);
+	Camera PrepareCamera(uint32_t frame);
+	float GetFrameTime(uint32_t frame) const;
+
+private:
+	const Scene _scene;
+	const CameraPath _cameraPath;
+	const Settings _settings;
+
+	Renderer _renderer{true};
+	ImageWriter _imageWriter;
+
+	std::atomic<uint32_t> _framesRendered = 0;
+	std::atomic<bool> _isCancelled = false;
+};
@@ -1,20 +1,183 @@
 ﻿#include "Utils.h"
 
+#include <cmath>
+#include <glm/glm.hpp>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#define RT_HAS_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#include "UtilsAvx2.h"
+
+namespace
+{
+	// Scalar version of the SIMD paths below, also converts the pixels left over at the end of a span.
+	template<Utils::ToneMap toneMap>
+	float MapChannel(float value, float scale, bool isAlpha)
+	{
+		value *= scale;
+		value = value > 0.0f ? value : 0.0f;
+		if (toneMap == Utils::ToneMap::Reinhard && !isAlpha)
+		{
+			value = value / (1.0f + value);
+		}
+
+		value = value < 1.0f ? value : 1.0f;
+		if (toneMap != Utils::ToneMap::None && !isAlpha)
+		{
+			value = std::sqrt(value);
+		}
+
+		return value * 255.0f + 0.5f;
+	}
+
+	template<Utils::ToneMap toneMap>
+	uint32_t ConvertPixel(const glm::vec4& color, float scale)
+	{
+		const auto r = static_cast<uint32_t>(MapChannel<toneMap>(color.r, scale, false));
+		const auto g = static_cast<uint32_t>(MapChannel<toneMap>(color.g, scale, false));
+		const auto b = static_cast<uint32_t>(MapChannel<toneMap>(color.b, scale, false));
+		const auto a = static_cast<uint32_t>(MapChannel<toneMap>(color.a, scale, true));
+		return (a << 24) | (b << 16) | (g << 8) | r;
+	}
+
+#ifdef RT_HAS_SSE2
+	template<Utils::ToneMap toneMap>
+	__m128i MapPixels(__m128 color, __m128 scale, __m128 alphaMask)
+	{
+		color = _mm_max_ps(_mm_mul_ps(color, scale), _mm_setzero_ps());
+		__m128 mapped = color;
+		if constexpr (toneMap == Utils::ToneMap::Reinhard)
+		{
+			mapped = _mm_div_ps(mapped, _mm_add_ps(_mm_set1_ps(1.0f), mapped));
+		}
+
+		mapped = _mm_min_ps(mapped, _mm_set1_ps(1.0f));
+		if constexpr (toneMap != Utils::ToneMap::None)
+		{
+			mapped = _mm_sqrt_ps(mapped);
+		}
+
+		const __m128 alpha = _mm_min_ps(color, _mm_set1_ps(1.0f));
+		color = _mm_or_ps(_mm_andnot_ps(alphaMask, mapped), _mm_and_ps(alphaMask, alpha));
+		return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(color, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+	}
+#endif
+
+	template<Utils::ToneMap toneMap>
+	void ConvertSpan(std::span<const glm::vec4> colors, std::span<uint32_t> output, float scale)
+	{
+		const size_t count = colors.size();
+		const float* input = &colors.data()->x;
+		size_t i = 0;
+
+#ifdef RT_HAS_SSE2
+		if (Utils::HasAvx2())
+		{
+			// Whole blocks of 8 pixels, SSE2 and the scalar loop take the rest.
+			i = UtilsAvx2::ConvertSpan(toneMap, input, output.data(), count, scale);
+		}
+
+		{
+			const __m128 scale4 = _mm_set1_ps(scale);
+			const __m128 alphaMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128i p0 = MapPixels<toneMap>(_mm_loadu_ps(input + i * 4 + 0), scale4, alphaMask);
+				const __m128i p1 = MapPixels<toneMap>(_mm_loadu_ps(input + i * 4 + 4), scale4, alphaMask);
+				const __m128i p2 = MapPixels<toneMap>(_mm_loadu_ps(input + i * 4 + 8), scale4, alphaMask);
+				const __m128i p3 = MapPixels<toneMap>(_mm_loadu_ps(input + i * 4 + 12), scale4, alphaMask);
+				const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output.data() + i), bytes);
+			}
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			output[i] = ConvertPixel<toneMap>(colors[i], scale);
+		}
+	}
+}
+
+bool Utils::HasAvx2()
+{
+#ifdef RT_HAS_SSE2
+	static const bool hasAvx2 = []
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+		{
+			return false;
+		}
+
+		// AVX2 needs the CPU flag and an OS that saves the YMM registers (OSXSAVE, then XCR0 bits 1 and 2).
+		__cpuid(info, 1);
+		const bool isOsSaving = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+		__cpuidex(info, 7, 0);
+		return isOsSaving && (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}();
+
+	return hasAvx2;
+#else
+	return false;
+#endif
+}
+
 uint32_t Utils::ConvertToRGBA(const glm::vec4& color)
 {
-	const auto r = static_cast<uint8_t>(color.r * 255.0f);
-	const auto g = static_cast<uint8_t>(color.g * 255.0f);
-	const auto b = static_cast<uint8_t>(color.b * 255.0f);
-	const auto a = static_cast<uint8_t>(color.a * 255.0f);
-	const uint32_t result = (a << 24) | (b << 16) | (g << 8) | r;
-	return result;
+	return ConvertPixel<ToneMap::None>(color, 1.0f);
 }
 
 uint32_t Utils::ConvertToRGBA(const glm::vec3& color)
 {
-	const auto r = static_cast<uint8_t>(color.r * 255.0f);
-	const auto g = static_cast<uint8_t>(color.g * 255.0f);
-	const auto b = static_cast<uint8_t>(color.b * 255.0f);
-	const uint32_t result = (255 << 24) | (b << 16) | (g << 8) | r;
-	return result;
+	return ConvertPixel<ToneMap::None>(glm::vec4(color, 1.0f), 1.0f);
+}
+
+void Utils::ConvertToRGBA(std::span<const glm::vec4> colors, std::span<uint32_t> output, float scale, ToneMap toneMap)
+{
+	switch (toneMap)
+	{
+	case ToneMap::None:
+		ConvertSpan<ToneMap::None>(colors, output, scale);
+		break;
+	case ToneMap::Gamma:
+		ConvertSpan<ToneMap::Gamma>(colors, output, scale);
+		break;
+	case ToneMap::Reinhard:
+		ConvertSpan<ToneMap::Reinhard>(colors, output, scale);
+		break;
+	}
+}
+
+uint32_t Utils::PCGHash(uint32_t input)
+{
+	const uint32_t state = input * 747796405u + 2891336453u;
+	const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+	return (word >> 22u) ^ word;
+}
+
+float Utils::RandomFloat(uint32_t& seed)
+{
+	seed = PCGHash(seed);
+	// The top 24 bits fit a float exactly, so the result stays in [0, 1) and never rounds up to 1.
+	return static_cast<float>(seed >> 8) * 0x1p-24f;
+}
+
+glm::vec3 Utils::RandomVec3(uint32_t& seed, float min, float max)
+{
+	const float x = RandomFloat(seed);
+	const float y = RandomFloat(seed);
+	const float z = RandomFloat(seed);
+	return glm::vec3(x, y, z) * (max - min) + min;
 }
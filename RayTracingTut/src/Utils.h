@@ -1,11 +1,60 @@
 ﻿#pragma once
 
+#include <memory>
+#include <span>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
 class Utils
 {
 public:
+	enum class ToneMap
+	{
+		None,
+		// Gamma 2.0, a cheap approximation of sRGB.
+		Gamma,
+		// Reinhard c / (1 + c) followed by gamma 2.0.
+		Reinhard,
+	};
+
+public:
+	// Clamps and rounds every channel to 8 bits, packed as ABGR (red in the low byte).
 	static uint32_t ConvertToRGBA(const glm::vec4& color);
 	static uint32_t ConvertToRGBA(const glm::vec3& color);
+	// Scales, tone maps, clamps and packs a whole row or tile, vectorized with SSE2, or AVX2 when the CPU has it.
+	// The tone map applies to RGB only. output must hold at least colors.size() pixels.
+	static void ConvertToRGBA(std::span<const glm::vec4> colors, std::span<uint32_t> output, float scale = 1.0f, ToneMap toneMap = ToneMap::None);
+	// True when the CPU and the OS support the AVX2 conversion, checked once.
+	static bool HasAvx2();
+
+	// Stateless per-pixel random numbers, the same seed gives the same image on any thread layout.
+	static uint32_t PCGHash(uint32_t input);
+	static float RandomFloat(uint32_t& seed);
+	static glm::vec3 RandomVec3(uint32_t& seed, float min, float max);
+};
+
+// Allocator that default-initializes elements, so resizing a buffer does not touch its memory.
+// The first write then decides which NUMA node backs each page.
+template<typename T>
+struct DefaultInitAllocator : std::allocator<T>
+{
+	template<typename U>
+	struct rebind
+	{
+		using other = DefaultInitAllocator<U>;
+	};
+
+	using std::allocator<T>::allocator;
+
+	template<typename U>
+	void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+	{
+		::new(static_cast<void*>(ptr)) U;
+	}
+
+	template<typename U, typename... Args>
+	void construct(U* ptr, Args&&... args)
+	{
+		std::construct_at(ptr, std::forward<Args>(args)...);
+	}
 };
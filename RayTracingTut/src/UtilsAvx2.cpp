@@ -0,0 +1,69 @@
+#include "UtilsAvx2.h"
+
+// premake builds this file alone with AVX2. It sticks to raw pointers and intrinsics, an inline function
+// from a shared header compiled here could otherwise be the copy the linker keeps for the whole program.
+#ifdef __AVX2__
+#include <immintrin.h>
+
+namespace
+{
+	template<Utils::ToneMap toneMap>
+	__m256i MapPixels(__m256 color, __m256 scale, __m256 alphaMask)
+	{
+		color = _mm256_max_ps(_mm256_mul_ps(color, scale), _mm256_setzero_ps());
+		__m256 mapped = color;
+		if constexpr (toneMap == Utils::ToneMap::Reinhard)
+		{
+			mapped = _mm256_div_ps(mapped, _mm256_add_ps(_mm256_set1_ps(1.0f), mapped));
+		}
+
+		mapped = _mm256_min_ps(mapped, _mm256_set1_ps(1.0f));
+		if constexpr (toneMap != Utils::ToneMap::None)
+		{
+			mapped = _mm256_sqrt_ps(mapped);
+		}
+
+		const __m256 alpha = _mm256_min_ps(color, _mm256_set1_ps(1.0f));
+		color = _mm256_blendv_ps(mapped, alpha, alphaMask);
+		return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(color, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+	}
+
+	template<Utils::ToneMap toneMap>
+	size_t ConvertBlocks(const float* input, uint32_t* output, size_t count, float scale)
+	{
+		// Two pixels per register, packing interleaves the 128-bit lanes so a final permute restores the order.
+		const __m256 scale8 = _mm256_set1_ps(scale);
+		const __m256 alphaMask = _mm256_castsi256_ps(_mm256_set_epi32(-1, 0, 0, 0, -1, 0, 0, 0));
+		const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i p01 = MapPixels<toneMap>(_mm256_loadu_ps(input + i * 4 + 0), scale8, alphaMask);
+			const __m256i p23 = MapPixels<toneMap>(_mm256_loadu_ps(input + i * 4 + 8), scale8, alphaMask);
+			const __m256i p45 = MapPixels<toneMap>(_mm256_loadu_ps(input + i * 4 + 16), scale8, alphaMask);
+			const __m256i p67 = MapPixels<toneMap>(_mm256_loadu_ps(input + i * 4 + 24), scale8, alphaMask);
+			const __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(p01, p23), _mm256_packs_epi32(p45, p67));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_permutevar8x32_epi32(bytes, order));
+		}
+
+		return i;
+	}
+}
+#endif
+
+size_t UtilsAvx2::ConvertSpan(Utils::ToneMap toneMap, const float* input, uint32_t* output, size_t count, float scale)
+{
+#ifdef __AVX2__
+	switch (toneMap)
+	{
+	case Utils::ToneMap::None:
+		return ConvertBlocks<Utils::ToneMap::None>(input, output, count, scale);
+	case Utils::ToneMap::Gamma:
+		return ConvertBlocks<Utils::ToneMap::Gamma>(input, output, count, scale);
+	case Utils::ToneMap::Reinhard:
+		return ConvertBlocks<Utils::ToneMap::Reinhard>(input, output, count, scale);
+	}
+#endif
+
+	return 0;
+}
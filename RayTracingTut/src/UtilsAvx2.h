@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Utils.h"
+
+// Kernels of the one file built with AVX2 enabled. Only call them after Utils::HasAvx2() returned true.
+namespace UtilsAvx2
+{
+	// Converts the leading whole blocks of 8 pixels like Utils::ConvertToRGBA and returns how many pixels it wrote.
+	size_t ConvertSpan(Utils::ToneMap toneMap, const float* input, uint32_t* output, size_t count, float scale);
+}
@@ -1,12 +1,23 @@
 #include "Walnut/Application.h"
+#include "Benchmark.h"
 #include "Camera.h"
+#include "CameraPath.h"
+#include "CommandLine.h"
+#include "ImageWriter.h"
+#include "RenderBackend.h"
 #include "Renderer.h"
 #include "Walnut/EntryPoint.h"
 #include "imgui.h"
 #include "Scene.h"
+#include "SceneEditor.h"
+#include "SequenceRenderer.h"
 #include "Walnut/Image.h"
 #include "Walnut/Timer.h"
 
+#include <atomic>
+#include <iostream>
+#include <string_view>
+#include <thread>
 #include <glm/gtc/type_ptr.hpp>
 
 using namespace Walnut;
@@ -14,34 +25,30 @@ using namespace Walnut;
 class ExampleLayer : public Walnut::Layer
 {
 public:
-	ExampleLayer()
-		: _camera(45.0f, 0.1f, 100.0f)
+	explicit ExampleLayer(std::string_view backendName)
+		: _camera(45.0f, 0.1f, 100.0f),
+		_sceneEditor(Scene::CreateDefault())
 	{
+		_renderTimes.resize(100);
+		_renderer.SetBackend(backendName);
+
+		_camera.SetRowExecutor([this](uint32_t height, const std::function<void(uint32_t)>& rowFunc)
 		{
-			Material& material = _scene.Materials.emplace_back();;
-			material.Albedo = {1.0f, 0.4f, 1.0f};
-			material.Roughness = 0.0f;
+			_renderer.ForEachRow(height, rowFunc);
+		});
+	}
 
-			Sphere sphere;
-			sphere.Radius = 1.0f;
-			sphere.Position = {0.0f, 0.0f, 0.0f};
-			sphere.MaterialIndex = 0;
-			_scene.Spheres.push_back(sphere);
+	~ExampleLayer() override
+	{
+		if (_sequenceRenderer)
+		{
+			_sequenceRenderer->Cancel();
 		}
 
+		if (_sequenceThread.joinable())
 		{
-			Material& material = _scene.Materials.emplace_back();;
-			material.Albedo = {0.2f, 0.9f, 1.0f};
-			material.Roughness = 0.02f;
-
-			Sphere sphere;
-			sphere.Radius = 100.0f;
-			sphere.Position = {0.0f, -101.0f, 0.0f};
-			sphere.MaterialIndex = 1;
-			_scene.Spheres.push_back(sphere);
+			_sequenceThread.join();
 		}
-
-		_renderTimes.resize(100);
 	}
 
 	virtual void OnUpdate(float ts) override
@@ -58,21 +65,27 @@ public:
 		DrawScenes();
 		DrawSpheres();
 		DrawMaterials();
+		DrawSequence();
 		DrawViewport();
 	}
 
-	void DrawMaterialControl(Material& material) const
+	bool DrawMaterialControl(Material& material) const
 	{
-		ImGui::ColorEdit3("Color", glm::value_ptr(material.Albedo));
-		ImGui::DragFloat("Roughness", &material.Roughness, 0.01f, 0.0f, 1.0f);
-		ImGui::DragFloat("Metallic", &material.Metallic, 0.01f, 0.0f, 1.0f);
+		bool isEdited = ImGui::ColorEdit3("Color", glm::value_ptr(material.Albedo));
+		isEdited |= ImGui::DragFloat("Roughness", &material.Roughness, 0.01f, 0.0f, 1.0f);
+		isEdited |= ImGui::DragFloat("Metallic", &material.Metallic, 0.01f, 0.0f, 1.0f);
+		isEdited |= ImGui::ColorEdit3("Emission Color", glm::value_ptr(material.EmissionColor));
+		isEdited |= ImGui::DragFloat("Emission Power", &material.EmissionPower, 0.05f, 0.0f, FLT_MAX);
+		return isEdited;
 	}
 
-	void DrawSphereControl(Sphere& sphere) const
+	bool DrawSphereControl(Sphere& sphere) const
 	{
-		ImGui::DragFloat("Radius", &sphere.Radius, 0.01f, 1000.0f);
-		ImGui::DragFloat3("Position", glm::value_ptr(sphere.Position), 0.01f);
-		ImGui::DragInt("Material Index", &sphere.MaterialIndex, 1.0f, 0, static_cast<int>(_scene.Materials.size() - 1));
+		const int maxMaterialIndex = static_cast<int>(_sceneEditor.GetScene().Materials.size() - 1);
+		bool isEdited = ImGui::DragFloat("Radius", &sphere.Radius, 0.01f, 1000.0f);
+		isEdited |= ImGui::DragFloat3("Position", glm::value_ptr(sphere.Position), 0.01f);
+		isEdited |= ImGui::DragInt("Material Index", &sphere.MaterialIndex, 1.0f, 0, maxMaterialIndex);
+		return isEdited;
 	}
 
 	void DrawSettings()
@@ -84,6 +97,7 @@ public:
 			ImGui::Text("Min render: %.3fms", _minRenderTime);
 			ImGui::Text("Max render: %.3fms", _maxRenderTime);
 			ImGui::Text("Average render: %.3fms", _averageRenderTime);
+			ImGui::Text("Rays: %.2f M/s", static_cast<float>(_renderer.GetRayCount()) / (_lastRenderTime * 1000.0f));
 		}
 		else
 		{
@@ -92,24 +106,113 @@ public:
 
 		ImGui::Checkbox("MultiThread", &_renderer.IsMultiThread);
 		ImGui::Checkbox("MultiThreadInner", &_renderer.IsMultiThreadInner);
+		ImGui::Checkbox("NUMA Aware", &_renderer.IsNumaAware);
+		ImGui::Checkbox("Compact Spheres", &_renderer.IsCompactGeometry);
+		DrawBackendControl();
+		if (_renderer.IsNumaAware)
+		{
+			DrawNodeStats();
+		}
+
 		if (ImGui::Button("Render"))
 		{
 			Render();
 		}
 
 		ImGui::Checkbox("Accumulate", &_renderer.GetSettings().ShouldAccumulate);
+		DrawToneMappingControl();
+		DrawIntegratorControl();
 		if (ImGui::Button("Reset"))
 		{
 			_renderer.ResetFrameIndex();
 		}
 
 		ImGui::Checkbox("RealTime", &_shouldRender);
+		if (_exportCount > 0)
+		{
+			ImGui::Text("Exported %u images, %u failed", _imageWriter.GetWrittenCount(), _imageWriter.GetFailedCount());
+		}
+
+
 		ImGui::DragFloat3("Light Direction", glm::value_ptr(_renderer.LightDirection), 0.01f, -1.0f, 1.0f);
 		ImGui::ColorEdit3("BackColor", glm::value_ptr(_renderer.BackColor));
 		ImGui::DragInt("Bounces", &_renderer.Bounces, 1, 1, 10);
 		ImGui::End();
 	}
 
+	void DrawToneMappingControl()
+	{
+		static constexpr const char* toneMapNames[] = {"None", "Gamma", "Reinhard"};
+		Utils::ToneMap& toneMapping = _renderer.GetSettings().ToneMapping;
+		if (ImGui::BeginCombo("Tone Mapping", toneMapNames[static_cast<int>(toneMapping)]))
+		{
+			for (int i = 0; i < IM_ARRAYSIZE(toneMapNames); i++)
+			{
+				if (ImGui::Selectable(toneMapNames[i], static_cast<int>(toneMapping) == i))
+				{
+					toneMapping = static_cast<Utils::ToneMap>(i);
+				}
+			}
+
+			ImGui::EndCombo();
+		}
+	}
+
+	void DrawBackendControl()
+	{
+		if (ImGui::BeginCombo("Backend", _renderer.GetBackendName()))
+		{
+			for (const std::string& backendName : RenderBackendRegistry::GetNames())
+			{
+				if (ImGui::Selectable(backendName.c_str(), backendName == _renderer.GetBackendName()))
+				{
+					_renderer.SetBackend(backendName);
+				}
+			}
+
+			ImGui::EndCombo();
+		}
+	}
+
+	void DrawIntegratorControl()
+	{
+		Renderer::Settings& settings = _renderer.GetSettings();
+		bool isChanged = ImGui::Checkbox("BSDF Sampling", &settings.UseBsdfSampling);
+		if (settings.UseBsdfSampling)
+		{
+			isChanged |= ImGui::Checkbox("Russian Roulette", &settings.UseRussianRoulette);
+			if (ImGui::IsItemHovered())
+			{
+				ImGui::SetTooltip("Randomly ends dim paths after the first bounce and reweights the survivors.\n"
+					"Needs at least 2 bounces, the last bounce is never cut.");
+			}
+		}
+
+		// Samples of the other integrator converge to a different image.
+		if (isChanged)
+		{
+			_renderer.ResetFrameIndex();
+		}
+	}
+
+	void DrawNodeStats() const
+	{
+		if (const NumaWorkerPool* workerPool = _renderer.GetWorkerPool())
+		{
+			ImGui::Text("%u workers on %u nodes, %s", workerPool->GetWorkerCount(), workerPool->GetNodeCount(),
+				workerPool->IsPinned() ? "pinned to cores" : "not pinned");
+		}
+
+		const uint32_t width = _renderer.GetWidth();
+		for (const auto& nodeStats : _renderer.GetNodeStats())
+		{
+			const float pixels = static_cast<float>(nodeStats.RowCount) * static_cast<float>(width);
+			const float megaPixelsPerSecond = nodeStats.Milliseconds > 0.0f ? pixels / (nodeStats.Milliseconds * 1000.0f) : 0.0f;
+			ImGui::Text("Node %u (%u workers): %u rows, %.3fms, %.2f MPix/s",
+				nodeStats.Node, nodeStats.WorkerCount, nodeStats.RowCount, nodeStats.Milliseconds, megaPixelsPerSecond);
+		}
+	}
+
 	void DrawScenes()
 	{
 		ImGui::Begin("Scene");
@@ -119,13 +222,13 @@ public:
 
 		if (ImGui::Button("Add Sphere"))
 		{
-			_scene.Spheres.push_back(newSphere);
+			_sceneEditor.AddSphere(newSphere);
 		}
 
 		ImGui::SameLine();
 		if (ImGui::Button("Clear Spheres"))
 		{
-			_scene.Spheres.clear();
+			_sceneEditor.ClearSpheres();
 		}
 
 		ImGui::End();
@@ -135,11 +238,16 @@ public:
 	{
 		ImGui::Begin("Spheres");
 
-		for (size_t i = 0; i < _scene.Spheres.size(); i++)
+		// Edit a copy, the editor records what changed.
+		for (size_t i = 0; i < _sceneEditor.GetScene().Spheres.size(); i++)
 		{
-			Sphere& sphere = _scene.Spheres[i];
+			Sphere sphere = _sceneEditor.GetScene().Spheres[i];
 			ImGui::PushID(static_cast<int>(i));
-			DrawSphereControl(sphere);
+			if (DrawSphereControl(sphere))
+			{
+				_sceneEditor.SetSphere(i, sphere);
+			}
+
 			ImGui::PopID();
 			ImGui::Separator();
 		}
@@ -151,12 +259,16 @@ public:
 	{
 		ImGui::Begin("Materials");
 
-		for (size_t i = 0; i < _scene.Materials.size(); i++)
+		for (size_t i = 0; i < _sceneEditor.GetScene().Materials.size(); i++)
 		{
-			Material& material = _scene.Materials[i];
+			Material material = _sceneEditor.GetScene().Materials[i];
 			ImGui::PushID(static_cast<int>(i));
 			ImGui::Text(std::format("Index {0}", i).c_str());
-			DrawMaterialControl(material);
+			if (DrawMaterialControl(material))
+			{
+				_sceneEditor.SetMaterial(i, material);
+			}
+
 			ImGui::PopID();
 			ImGui::Separator();
 		}
@@ -164,6 +276,134 @@ public:
 		ImGui::End();
 	}
 
+	void DrawSequence()
+	{
+		ImGui::Begin("Sequence");
+
+		ImGui::Text("Keyframes: %zu", _cameraPath.GetKeyframes().size());
+		if (ImGui::Button("Add Keyframe"))
+		{
+			CameraPath::Keyframe keyframe;
+			keyframe.Time = _cameraPath.GetKeyframes().empty() ? 0.0f : _cameraPath.GetEndTime() + _keyframeSpacing;
+			keyframe.Position = _camera.GetPosition();
+			keyframe.Direction = _camera.GetDirection();
+			_cameraPath.AddKeyframe(keyframe);
+		}
+
+		ImGui::SameLine();
+		if (ImGui::Button("Clear Keyframes"))
+		{
+			_cameraPath.Clear();
+		}
+
+		ImGui::DragFloat("Keyframe Spacing", &_keyframeSpacing, 0.1f, 0.1f, 60.0f);
+
+		// The same file format --sequence renders headless.
+		ImGui::InputText("Path File", _cameraPathFile, sizeof(_cameraPathFile));
+		if (ImGui::Button("Save Path"))
+		{
+			_cameraPathStatus = _cameraPath.SaveToFile(_cameraPathFile) ? "Saved" : "Save failed";
+		}
+
+		ImGui::SameLine();
+		if (ImGui::Button("Load Path"))
+		{
+			_cameraPathStatus = _cameraPath.LoadFromFile(_cameraPathFile) ? "Loaded" : "Load failed";
+		}
+
+		if (_cameraPathStatus)
+		{
+			ImGui::SameLine();
+			ImGui::Text("%s", _cameraPathStatus);
+		}
+
+		ImGui::DragInt("Frames", &_sequenceFrameCount, 1.0f, 1, 10000);
+		ImGui::DragInt("Samples Per Frame", &_sequenceSamples, 1.0f, 1, 4096);
+		ImGui::InputText("Output", _sequenceOutput, sizeof(_sequenceOutput));
+		const bool isOutputValid = SequenceRenderer::IsValidOutputPattern(_sequenceOutput);
+		if (!isOutputValid)
+		{
+			ImGui::Text("Output needs a frame number field like {:04} and a .png, .ppm or .pfm extension");
+		}
+
+		if (_isSequenceRunning)
+		{
+			const float progress = static_cast<float>(_sequenceRenderer->GetFramesRendered()) / static_cast<float>(_sequenceRenderer->GetFrameCount());
+			ImGui::ProgressBar(progress);
+			if (ImGui::Button("Cancel"))
+			{
+				_sequenceRenderer->Cancel();
+			}
+		}
+		else
+		{
+			if (ImGui::Button("Render Sequence") && !_cameraPath.GetKeyframes().empty() && isOutputValid)
+			{
+				StartSequence();
+			}
+
+			if (_sequenceStats.FramesRendered > 0)
+			{
+				ImGui::Text("Last sequence: %u frames in %.1fs, %.1f frames/hour",
+					_sequenceStats.FramesRendered, _sequenceStats.Seconds, _sequenceStats.FramesPerHour);
+			}
+		}
+
+		ImGui::End();
+	}
+
+	void ExportImage(bool isHdr)
+	{
+		const uint32_t width = _renderer.GetWidth();
+		const uint32_t height = _renderer.GetHeight();
+		if (width == 0 || height == 0 || _renderer.GetAccumulatedSampleCount() == 0)
+		{
+			return;
+		}
+
+		// Copy the accumulation here, tone mapping and encoding stream on the writer thread.
+		_exportCount++;
+		const glm::vec4* accumulationData = _renderer.GetAccumulationData();
+		_imageWriter.EnqueueHdr(std::format("exports/render_{:04}.{}", _exportCount, isHdr ? "pfm" : "png"), width, height,
+			std::vector<glm::vec4>(accumulationData, accumulationData + static_cast<size_t>(width) * height),
+			1.0f / static_cast<float>(_renderer.GetAccumulatedSampleCount()), _renderer.GetSettings().ToneMapping);
+	}
+
+	void StartSequence()
+	{
+		if (_sequenceThread.joinable())
+		{
+			_sequenceThread.join();
+		}
+
+		SequenceRenderer::Settings settings;
+		settings.Width = _viewportWidth > 0 ? _viewportWidth : settings.Width;
+		settings.Height = _viewportHeight > 0 ? _viewportHeight : settings.Height;
+		settings.FrameCount = static_cast<uint32_t>(_sequenceFrameCount);
+		settings.SamplesPerFrame = static_cast<uint32_t>(_sequenceSamples);
+		settings.OutputPattern = _sequenceOutput;
+
+		_sequenceRenderer = std::make_unique<SequenceRenderer>(_sceneEditor.GetScene(), _cameraPath, settings);
+		Renderer& renderer = _sequenceRenderer->GetRenderer();
+		renderer.Bounces = _renderer.Bounces;
+		renderer.LightDirection = _renderer.LightDirection;
+		renderer.BackColor = _renderer.BackColor;
+		renderer.IsMultiThread = true;
+		renderer.IsNumaAware = _renderer.IsNumaAware;
+		renderer.IsCompactGeometry = _renderer.IsCompactGeometry;
+		renderer.SetBackend(_renderer.GetBackendName());
+		renderer.GetSettings().ToneMapping = _renderer.GetSettings().ToneMapping;
+		renderer.GetSettings().UseBsdfSampling = _renderer.GetSettings().UseBsdfSampling;
+		renderer.GetSettings().UseRussianRoulette = _renderer.GetSettings().UseRussianRoulette;
+
+		_isSequenceRunning = true;
+		_sequenceThread = std::thread([this]
+		{
+			_sequenceStats = _sequenceRenderer->Run();
+			_isSequenceRunning = false;
+		});
+	}
+
 	void DrawViewport()
 	{
 		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
@@ -196,8 +436,21 @@ public:
 		// Renderer resize
 		_renderer.OnResize(_viewportWidth, _viewportHeight);
 		_camera.OnResize(_viewportWidth, _viewportHeight);
+		// The ray directions follow the framebuffer onto the nodes that trace each row.
+		if (_isCameraNumaPlaced != _renderer.IsNumaAware)
+		{
+			_camera.ReplaceRayDirections();
+			_isCameraNumaPlaced = _renderer.IsNumaAware;
+		}
+
+		// Publish the edits made since the last frame, only visible changes restart accumulation.
+		if (_sceneEditor.Commit().AffectsImage)
+		{
+			_renderer.ResetFrameIndex();
+		}
+
 		// Renderer render
-		_renderer.Render(_scene, _camera);
+		_renderer.Render(_sceneEditor.GetSnapshot(), _camera);
 
 		_lastRenderTime = timer.ElapsedMillis();
 		if (_lastRenderTime < _minRenderTime)
@@ -229,7 +482,7 @@ public:
 private:
 	Renderer _renderer;
 	Camera _camera;
-	Scene _scene;
+	SceneEditor _sceneEditor;
 
 	uint32_t _viewportWidth = 0;
 	uint32_t _viewportHeight = 0;
@@ -242,19 +495,104 @@ private:
 	float _averageRenderTime;
 
 	bool _shouldRender = false;
+	bool _isCameraNumaPlaced = false;
+
+	ImageWriter _imageWriter;
+	uint32_t _exportCount = 0;
+
+	CameraPath _cameraPath;
+	float _keyframeSpacing = 1.0f;
+	char _cameraPathFile[256] = "camera_path.txt";
+	const char* _cameraPathStatus = nullptr;
+	int _sequenceFrameCount = 60;
+	int _sequenceSamples = 16;
+	char _sequenceOutput[256] = "frames/frame_{:04}.png";
+	std::unique_ptr<SequenceRenderer> _sequenceRenderer;
+	SequenceRenderer::Stats _sequenceStats;
+	std::atomic<bool> _isSequenceRunning = false;
+	std::thread _sequenceThread;
 };
 
+static int RunSequence(const CommandLine& commandLine)
+{
+	CameraPath cameraPath;
+	if (!cameraPath.LoadFromFile(commandLine.SequencePath))
+	{
+		std::cerr << "Failed to load camera path " << commandLine.SequencePath << "\n";
+		return 1;
+	}
+
+	SequenceRenderer::Settings settings;
+	settings.Width = commandLine.Width;
+	settings.Height = commandLine.Height;
+	settings.FrameCount = commandLine.FrameCount;
+	settings.SamplesPerFrame = commandLine.SamplesPerFrame;
+	settings.OutputPattern = commandLine.OutputPattern;
+
+	SequenceRenderer sequenceRenderer(Scene::CreateDefault(), cameraPath, settings);
+	Renderer& renderer = sequenceRenderer.GetRenderer();
+	renderer.Bounces = commandLine.Bounces;
+	renderer.IsMultiThread = true;
+	renderer.IsNumaAware = commandLine.IsNumaAware;
+	renderer.IsCompactGeometry = commandLine.IsCompactGeometry;
+	renderer.SetBackend(commandLine.BackendName);
+	renderer.GetSettings().UseBsdfSampling = !commandLine.UseLegacyShading;
+	renderer.GetSettings().UseRussianRoulette = commandLine.UseRussianRoulette;
+
+	const SequenceRenderer::Stats stats = sequenceRenderer.Run();
+	std::cout << "Rendered " << stats.FramesRendered << " frames in " << stats.Seconds << "s, "
+		<< stats.FramesPerHour << " frames/hour\n";
+	if (sequenceRenderer.GetFailedWrites() > 0)
+	{
+		std::cerr << sequenceRenderer.GetFailedWrites() << " frames could not be written\n";
+		return 1;
+	}
+
+	return stats.FramesRendered == settings.FrameCount ? 0 : 1;
+}
+
 Walnut::Application* Walnut::CreateApplication(int argc, char** argv)
 {
+	const CommandLine commandLine = CommandLine::Parse(argc, argv);
+	if (commandLine.HasErrors)
+	{
+		CommandLine::PrintUsage();
+		std::exit(1);
+	}
+
+	if (commandLine.ShouldBenchmark)
+	{
+		Benchmark::Options options;
+		options.Width = commandLine.Width;
+		options.Height = commandLine.Height;
+		std::exit(Benchmark::Run(options));
+	}
+
+	if (commandLine.IsHeadless())
+	{
+		std::exit(RunSequence(commandLine));
+	}
+
 	Walnut::ApplicationSpecification spec;
 	spec.Name = "Ray Tracing";
 
 	auto* app = new Walnut::Application(spec);
-	app->PushLayer<ExampleLayer>();
-	app->SetMenubarCallback([app]()
+	const auto layer = std::make_shared<ExampleLayer>(commandLine.BackendName);
+	app->PushLayer(layer);
+	app->SetMenubarCallback([app, layer]()
 	{
 		if (ImGui::BeginMenu("File"))
 		{
+			if (ImGui::MenuItem("Export PNG"))
+			{
+				layer->ExportImage(false);
+			}
+
+			if (ImGui::MenuItem("Export PFM"))
+			{
+				layer->ExportImage(true);
+			}
+
 			if (ImGui::MenuItem("Exit"))
 			{
 				app->Close();
@@ -0,0 +1,115 @@
+#include "WavefrontBackend.h"
+
+#include <limits>
+
+void WavefrontBackend::RenderFrame(const FrameContext& context)
+{
+	const PathTracer pathTracer(context);
+	context.ForEachRow([&context, &pathTracer](uint32_t y)
+	{
+		RenderRow(context, pathTracer, y);
+	});
+}
+
+void WavefrontBackend::RenderRow(const FrameContext& context, const PathTracer& pathTracer, uint32_t y)
+{
+	thread_local Wave wave;
+
+	wave.Paths.resize(context.Width);
+	wave.ActivePaths.clear();
+	for (uint32_t x = 0; x < context.Width; x++)
+	{
+		wave.Paths[x] = pathTracer.BeginPath(x, y);
+		if (wave.Paths[x].IsActive)
+		{
+			wave.ActivePaths.push_back(x);
+		}
+	}
+
+	uint64_t rayCount = 0;
+	while (!wave.ActivePaths.empty())
+	{
+		wave.Rays.clear();
+		for (const uint32_t pathIndex : wave.ActivePaths)
+		{
+			wave.Rays.push_back(wave.Paths[pathIndex].CurrentRay);
+		}
+
+		TraceRays(pathTracer, wave.Rays, wave.Hits, wave);
+		rayCount += wave.Rays.size();
+
+		wave.Shadows.clear();
+		wave.ShadowPaths.clear();
+		wave.ShadowRays.clear();
+		for (size_t i = 0; i < wave.ActivePaths.size(); i++)
+		{
+			const uint32_t pathIndex = wave.ActivePaths[i];
+			const PathTracer::ShadowRequest shadow = pathTracer.Shade(wave.Paths[pathIndex], wave.Hits[i]);
+			if (shadow.IsPending)
+			{
+				wave.Shadows.push_back(shadow);
+				wave.ShadowPaths.push_back(pathIndex);
+				wave.ShadowRays.push_back(shadow.ShadowRay);
+			}
+		}
+
+		TraceRays(pathTracer, wave.ShadowRays, wave.ShadowHits, wave);
+		rayCount += wave.ShadowRays.size();
+		for (size_t i = 0; i < wave.Shadows.size(); i++)
+		{
+			if (!wave.ShadowHits[i].IsHit())
+			{
+				wave.Paths[wave.ShadowPaths[i]].Color += wave.Shadows[i].Contribution;
+			}
+		}
+
+		std::erase_if(wave.ActivePaths, [](uint32_t pathIndex) { return !wave.Paths[pathIndex].IsActive; });
+	}
+
+	const uint32_t rowStart = y * context.Width;
+	for (uint32_t x = 0; x < context.Width; x++)
+	{
+		context.Accumulate(rowStart + x, glm::vec4(wave.Paths[x].Color, 1.0f));
+	}
+
+	context.RayCount->fetch_add(rayCount, std::memory_order_relaxed);
+	context.Resolve(rowStart, context.Width);
+}
+
+void WavefrontBackend::TraceRays(const PathTracer& pathTracer, const std::vector<Ray>& rays, std::vector<PathTracer::Hit>& hits, Wave& wave)
+{
+	hits.assign(rays.size(), PathTracer::Hit());
+
+	wave.CandidateRays.clear();
+	wave.CandidateSlots.clear();
+	for (size_t i = 0; i < rays.size(); i++)
+	{
+		if (pathTracer.MayHitScene(rays[i]))
+		{
+			wave.CandidateRays.push_back(rays[i]);
+			wave.CandidateSlots.push_back(static_cast<uint32_t>(i));
+		}
+	}
+
+	const size_t candidateCount = wave.CandidateRays.size();
+	wave.ClosestHits.assign(candidateCount, std::numeric_limits<float>::max());
+	wave.ClosestSpheres.assign(candidateCount, -1);
+	pathTracer.ForEachSphere([&wave, candidateCount](uint32_t index, const glm::vec3& center, float radius)
+	{
+		for (size_t i = 0; i < candidateCount; i++)
+		{
+			if (PathTracer::IntersectSphere(wave.CandidateRays[i], center, radius, wave.ClosestHits[i]))
+			{
+				wave.ClosestSpheres[i] = static_cast<int>(index);
+			}
+		}
+	});
+
+	for (size_t i = 0; i < candidateCount; i++)
+	{
+		if (wave.ClosestSpheres[i] >= 0)
+		{
+			hits[wave.CandidateSlots[i]] = {wave.ClosestHits[i], static_cast<uint32_t>(wave.ClosestSpheres[i])};
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "PathTracer.h"
+#include "RenderBackend.h"
+
+// Traces a whole row as one wave: every bounce first intersects all live rays of the row,
+// sphere by sphere, then shades them. Each sphere is read once per wave instead of once per ray,
+// which keeps large scenes from streaming through the cache for every single ray.
+class WavefrontBackend : public RenderBackend
+{
+public:
+	static constexpr const char* Name = "Wavefront";
+
+	const char* GetName() const override { return Name; }
+	void RenderFrame(const FrameContext& context) override;
+
+private:
+	// Buffers of one row, kept per thread so rows after the first don't allocate.
+	struct Wave
+	{
+		std::vector<PathTracer::Path> Paths;
+		std::vector<uint32_t> ActivePaths;
+		std::vector<Ray> Rays;
+		std::vector<PathTracer::Hit> Hits;
+
+		std::vector<PathTracer::ShadowRequest> Shadows;
+		std::vector<uint32_t> ShadowPaths;
+		std::vector<Ray> ShadowRays;
+		std::vector<PathTracer::Hit> ShadowHits;
+
+		// Rays that made it past the scene bounds, with their slot in the input.
+		std::vector<Ray> CandidateRays;
+		std::vector<uint32_t> CandidateSlots;
+		std::vector<float> ClosestHits;
+		std::vector<int> ClosestSpheres;
+	};
+
+	static void RenderRow(const FrameContext& context, const PathTracer& pathTracer, uint32_t y);
+	// Same hits as PathTracer::TraceRay for every ray, with the sphere loop outside the ray loop.
+	static void TraceRays(const PathTracer& pathTracer, const std::vector<Ray>& rays, std::vector<PathTracer::Hit>& hits, Wave& wave);
+};
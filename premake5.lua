@@ -7,4 +7,5 @@ workspace "RayTracingTut"
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 include "Walnut/WalnutExternal.lua"
 
-include "RayTracingTut"
\ No newline at end of file
+include "RayTracingTut"
+include "RayTracingTests"
\ No newline at end of file